@@ -0,0 +1,17 @@
+#pragma once
+
+#include<chrono>
+
+typedef std::chrono::high_resolution_clock BenchmarkClock;
+
+inline double MillisecondsSince(BenchmarkClock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(BenchmarkClock::now() - start).count();
+}
+
+// Each prints its timings and returns the number of failed result checks
+int RunTessellatorBenchmark();
+int RunMath2DBenchmark();
+int RunJobSystemStress();
+int RunPhysicsBenchmark();
+int RunParticleBenchmark();
@@ -0,0 +1,183 @@
+#include "Benchmark.h"
+#include "JobSystem.h"
+
+#include<atomic>
+#include<cstdio>
+#include<memory>
+#include<thread>
+#include<vector>
+
+// Repeats every scenario so rare interleavings get a chance to show up. Every write the
+// jobs make is plain memory, so a build with -fsanitize=thread also reports any missing
+// happens-before edge in the scheduler, not only wrong totals.
+const unsigned int ROUNDS = 20;
+const unsigned int MIN_WORKERS = 3;
+const unsigned int OUTER_COUNT = 64;
+const unsigned int INNER_COUNT = 4096;
+const unsigned int CHAIN_COUNT = 16;
+const unsigned int CHAIN_LENGTH = 500;
+const unsigned int SUBMITTER_COUNT = 4;
+const unsigned int SUBMITTED_JOBS = 5000;
+// Well past the 4096 jobs a deque holds, so pushes overflow and run inline
+const unsigned int FLOOD_JOBS = 20000;
+
+// ParallelFor inside ParallelFor: every cell must be visited exactly once
+static int NestedParallelFor(JobSystem& jobs)
+{
+	std::vector<unsigned int> visits(OUTER_COUNT * INNER_COUNT, 0);
+	jobs.ParallelFor(OUTER_COUNT, 1, [&](unsigned int rowBegin, unsigned int rowEnd)
+	{
+		for (unsigned int row = rowBegin; row < rowEnd; row++)
+		{
+			jobs.ParallelFor(INNER_COUNT, 0, [&](unsigned int begin, unsigned int end)
+			{
+				for (unsigned int i = begin; i < end; i++)
+					visits[row * INNER_COUNT + i]++;
+			});
+		}
+	});
+
+	int failures = 0;
+	for (unsigned int count : visits)
+	{
+		if (count != 1)
+			failures++;
+	}
+	return failures ? 1 : 0;
+}
+
+// Each job waits on the one before it, so a chain must run strictly in order
+static int DependencyChains(JobSystem& jobs)
+{
+	std::vector<std::unique_ptr<JobCounter>> counters(CHAIN_COUNT * CHAIN_LENGTH);
+	for (std::unique_ptr<JobCounter>& counter : counters)
+		counter.reset(new JobCounter());
+	std::vector<unsigned int> steps(CHAIN_COUNT, 0);
+	std::atomic<unsigned int> outOfOrder(0);
+
+	for (unsigned int link = 0; link < CHAIN_LENGTH; link++)
+	{
+		for (unsigned int chain = 0; chain < CHAIN_COUNT; chain++)
+		{
+			JobCounter* dependency = link > 0 ? counters[chain * CHAIN_LENGTH + link - 1].get() : nullptr;
+			jobs.Run([&steps, &outOfOrder, chain, link]()
+			{
+				if (steps[chain] != link)
+					outOfOrder++;
+				steps[chain] = link + 1;
+			}, counters[chain * CHAIN_LENGTH + link].get(), dependency);
+		}
+	}
+
+	for (std::unique_ptr<JobCounter>& counter : counters)
+		jobs.Wait(*counter);
+
+	int failures = outOfOrder.load() ? 1 : 0;
+	for (unsigned int step : steps)
+	{
+		if (step != CHAIN_LENGTH)
+			failures++;
+	}
+	return failures ? 1 : 0;
+}
+
+// Threads that don't own a deque submit and wait while the main thread does the same
+static int ExternalSubmitters(JobSystem& jobs)
+{
+	std::vector<unsigned int> done(SUBMITTER_COUNT * SUBMITTED_JOBS, 0);
+	std::vector<std::thread> submitters;
+	for (unsigned int s = 0; s < SUBMITTER_COUNT; s++)
+	{
+		submitters.emplace_back([&jobs, &done, s]()
+		{
+			JobCounter counter;
+			for (unsigned int i = 0; i < SUBMITTED_JOBS; i++)
+			{
+				unsigned int* slot = &done[s * SUBMITTED_JOBS + i];
+				jobs.Run([slot]() { (*slot)++; }, &counter);
+			}
+			jobs.Wait(counter);
+		});
+	}
+
+	std::atomic<unsigned int> mainJobs(0);
+	JobCounter counter;
+	for (unsigned int i = 0; i < SUBMITTED_JOBS; i++)
+		jobs.Run([&mainJobs]() { mainJobs++; }, &counter);
+	jobs.Wait(counter);
+
+	for (std::thread& submitter : submitters)
+		submitter.join();
+
+	int failures = mainJobs.load() != SUBMITTED_JOBS ? 1 : 0;
+	for (unsigned int count : done)
+	{
+		if (count != 1)
+			failures++;
+	}
+	return failures ? 1 : 0;
+}
+
+// More jobs than a deque holds, pushed from the main thread and from inside a worker job
+static int DequeOverflow(JobSystem& jobs)
+{
+	std::vector<unsigned int> fromMain(FLOOD_JOBS, 0), fromJob(FLOOD_JOBS, 0);
+
+	JobCounter counter;
+	for (unsigned int i = 0; i < FLOOD_JOBS; i++)
+	{
+		unsigned int* slot = &fromMain[i];
+		jobs.Run([slot]() { (*slot)++; }, &counter);
+	}
+	jobs.Run([&jobs, &fromJob]()
+	{
+		JobCounter children;
+		for (unsigned int i = 0; i < FLOOD_JOBS; i++)
+		{
+			unsigned int* slot = &fromJob[i];
+			jobs.Run([slot]() { (*slot)++; }, &children);
+		}
+		jobs.Wait(children);
+	}, &counter);
+	jobs.Wait(counter);
+
+	int failures = 0;
+	for (unsigned int i = 0; i < FLOOD_JOBS; i++)
+	{
+		if (fromMain[i] != 1 || fromJob[i] != 1)
+			failures++;
+	}
+	return failures ? 1 : 0;
+}
+
+int RunJobSystemStress()
+{
+	struct Scenario
+	{
+		const char* name;
+		int (*run)(JobSystem&);
+	};
+	static const Scenario scenarios[] = {
+		{ "nested ParallelFor", NestedParallelFor },
+		{ "dependency chains", DependencyChains },
+		{ "external submitters", ExternalSubmitters },
+		{ "deque overflow", DequeOverflow },
+	};
+
+	// At least a few workers even on small machines, or there is nothing to steal from
+	const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	JobSystem jobs(hardwareThreads > MIN_WORKERS ? hardwareThreads - 1 : MIN_WORKERS);
+	std::printf("%u threads, %u rounds\n", jobs.GetThreadCount(), ROUNDS);
+
+	int failures = 0;
+	for (const Scenario& scenario : scenarios)
+	{
+		int scenarioFailures = 0;
+		BenchmarkClock::time_point start = BenchmarkClock::now();
+		for (unsigned int round = 0; round < ROUNDS; round++)
+			scenarioFailures += scenario.run(jobs);
+		std::printf("%s: %.1f ms per round, %d failed round(s)\n", scenario.name, MillisecondsSince(start) / ROUNDS, scenarioFailures);
+		failures += scenarioFailures;
+	}
+	return failures;
+}
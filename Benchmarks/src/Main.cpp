@@ -0,0 +1,42 @@
+#include "Benchmark.h"
+
+#include<cstring>
+#include<iostream>
+
+// Microbenchmarks and stress tests for the renderer's CPU code, which needs no window or
+// GL context. Run with no arguments for all of them, or name the ones to run.
+struct Benchmark
+{
+	const char* name;
+	int (*run)();
+};
+
+static const Benchmark s_Benchmarks[] = {
+	{ "tessellator", RunTessellatorBenchmark },
+	{ "math2d", RunMath2DBenchmark },
+	{ "jobs", RunJobSystemStress },
+	{ "physics", RunPhysicsBenchmark },
+	{ "particles", RunParticleBenchmark },
+};
+
+int main(int argc, char** argv)
+{
+	int failures = 0;
+	for (const Benchmark& benchmark : s_Benchmarks)
+	{
+		bool selected = argc < 2;
+		for (int i = 1; i < argc; i++)
+			selected = selected || std::strcmp(argv[i], benchmark.name) == 0;
+		if (!selected)
+			continue;
+
+		std::cout << "[" << benchmark.name << "]" << std::endl;
+		failures += benchmark.run();
+	}
+
+	if (failures)
+		std::cout << failures << " check(s) failed" << std::endl;
+	else
+		std::cout << "All checks passed" << std::endl;
+	return failures ? 1 : 0;
+}
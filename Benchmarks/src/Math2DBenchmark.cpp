@@ -0,0 +1,143 @@
+#include "Benchmark.h"
+#include "Math2D.h"
+
+#include<cmath>
+#include<cstdio>
+#include<cstdlib>
+#include<vector>
+
+const unsigned int POINT_COUNT = 10000000;
+// The transform passes are short, so they are averaged over a few repeats
+const unsigned int TRANSFORM_REPEATS = 5;
+
+static float RandomFloat(float min, float max)
+{
+	return min + (max - min) * (std::rand() / (float)RAND_MAX);
+}
+
+// The batch functions against the scalar code they replace, which also serves as the
+// reference the results are checked against
+int RunMath2DBenchmark()
+{
+	int failures = 0;
+
+	std::vector<Vec2> points(POINT_COUNT), expected(POINT_COUNT), transformed(POINT_COUNT);
+	std::vector<float> x(POINT_COUNT), y(POINT_COUNT), xOut(POINT_COUNT), yOut(POINT_COUNT);
+	std::vector<float> angles(POINT_COUNT), t(POINT_COUNT);
+	std::vector<float> scaleX(POINT_COUNT, 1.5f), scaleY(POINT_COUNT, 0.5f);
+
+	std::srand(1);
+	for (unsigned int i = 0; i < POINT_COUNT; i++)
+	{
+		points[i] = Vec2(RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f));
+		x[i] = points[i].x;
+		y[i] = points[i].y;
+		angles[i] = RandomFloat(-100.0f, 100.0f);
+		// A little outside [0, 1] so the clamp is exercised
+		t[i] = RandomFloat(-0.1f, 1.1f);
+	}
+
+	// TransformPoints
+	const Mat3 transform = Mat3::TRS(0.3f, -0.2f, 0.7f, 1.2f, 0.8f);
+	BenchmarkClock::time_point start = BenchmarkClock::now();
+	for (unsigned int i = 0; i < POINT_COUNT; i++)
+		expected[i] = transform.TransformPoint(points[i]);
+	const double scalarTransformMs = MillisecondsSince(start);
+
+	start = BenchmarkClock::now();
+	for (unsigned int r = 0; r < TRANSFORM_REPEATS; r++)
+		TransformPoints(transform, points.data(), transformed.data(), POINT_COUNT);
+	const double interleavedMs = MillisecondsSince(start) / TRANSFORM_REPEATS;
+
+	start = BenchmarkClock::now();
+	for (unsigned int r = 0; r < TRANSFORM_REPEATS; r++)
+		TransformPoints(transform, x.data(), y.data(), xOut.data(), yOut.data(), POINT_COUNT);
+	const double soaMs = MillisecondsSince(start) / TRANSFORM_REPEATS;
+
+	for (unsigned int i = 0; i < POINT_COUNT; i++)
+	{
+		if (std::fabs(transformed[i].x - expected[i].x) > 1e-5f || std::fabs(transformed[i].y - expected[i].y) > 1e-5f ||
+			std::fabs(xOut[i] - expected[i].x) > 1e-5f || std::fabs(yOut[i] - expected[i].y) > 1e-5f)
+		{
+			failures++;
+			break;
+		}
+	}
+
+	// SinCos
+	std::vector<float> sines(POINT_COUNT), cosines(POINT_COUNT);
+	start = BenchmarkClock::now();
+	for (unsigned int i = 0; i < POINT_COUNT; i++)
+	{
+		sines[i] = std::sin(angles[i]);
+		cosines[i] = std::cos(angles[i]);
+	}
+	const double scalarSinCosMs = MillisecondsSince(start);
+
+	start = BenchmarkClock::now();
+	SinCos(angles.data(), sines.data(), cosines.data(), POINT_COUNT);
+	const double sinCosMs = MillisecondsSince(start);
+
+	double maxError = 0.0;
+	for (unsigned int i = 0; i < POINT_COUNT; i++)
+	{
+		maxError = std::fmax(maxError, std::fabs(sines[i] - std::sin((double)angles[i])));
+		maxError = std::fmax(maxError, std::fabs(cosines[i] - std::cos((double)angles[i])));
+	}
+	// Signed zero, large angles and the quadrant boundaries
+	const float edgeAngles[] = { 0.0f, -0.0f, 8000.0f, -8191.0f, 3.14159265f, 1.5707963f, -2.356f };
+	const unsigned int edgeCount = sizeof(edgeAngles) / sizeof(edgeAngles[0]);
+	float edgeSines[edgeCount], edgeCosines[edgeCount];
+	SinCos(edgeAngles, edgeSines, edgeCosines, edgeCount);
+	for (unsigned int i = 0; i < edgeCount; i++)
+	{
+		maxError = std::fmax(maxError, std::fabs(edgeSines[i] - std::sin((double)edgeAngles[i])));
+		maxError = std::fmax(maxError, std::fabs(edgeCosines[i] - std::cos((double)edgeAngles[i])));
+	}
+	if (maxError > 2e-6)
+		failures++;
+
+	// BuildTRS
+	std::vector<Mat3> expectedMatrices(POINT_COUNT), matrices(POINT_COUNT);
+	start = BenchmarkClock::now();
+	for (unsigned int i = 0; i < POINT_COUNT; i++)
+		expectedMatrices[i] = Mat3::TRS(x[i], y[i], angles[i], scaleX[i], scaleY[i]);
+	const double scalarTRSMs = MillisecondsSince(start);
+
+	start = BenchmarkClock::now();
+	BuildTRS(x.data(), y.data(), angles.data(), scaleX.data(), scaleY.data(), matrices.data(), POINT_COUNT);
+	const double trsMs = MillisecondsSince(start);
+
+	bool trsMatches = true;
+	for (unsigned int i = 0; i < POINT_COUNT && trsMatches; i++)
+	{
+		for (unsigned int k = 0; k < 9; k++)
+			trsMatches = trsMatches && std::fabs(matrices[i].m[k] - expectedMatrices[i].m[k]) <= 3e-6f;
+	}
+	if (!trsMatches)
+		failures++;
+
+	// EvaluateGradient
+	std::vector<Vec4> colors(POINT_COUNT);
+	const Vec4 from(1.0f, 0.0f, 0.0f, 1.0f), to(0.0f, 0.0f, 1.0f, 0.5f);
+	start = BenchmarkClock::now();
+	EvaluateGradient(from, to, t.data(), colors.data(), POINT_COUNT);
+	const double gradientMs = MillisecondsSince(start);
+
+	for (unsigned int i = 0; i < POINT_COUNT; i++)
+	{
+		const float clamped = t[i] < 0.0f ? 0.0f : t[i] > 1.0f ? 1.0f : t[i];
+		if (std::fabs(colors[i].x - (1.0f - clamped)) > 1e-6f || std::fabs(colors[i].w - (1.0f - 0.5f * clamped)) > 1e-6f)
+		{
+			failures++;
+			break;
+		}
+	}
+
+	std::printf("%u points: scalar TransformPoint %.1f ms, TransformPoints interleaved %.1f ms, SoA %.1f ms\n",
+		POINT_COUNT, scalarTransformMs, interleavedMs, soaMs);
+	std::printf("%u angles: std::sin/cos %.1f ms, SinCos %.1f ms (max error %.2g)\n", POINT_COUNT, scalarSinCosMs, sinCosMs, maxError);
+	std::printf("%u transforms: Mat3::TRS %.1f ms, BuildTRS %.1f ms\n", POINT_COUNT, scalarTRSMs, trsMs);
+	std::printf("%u gradient samples: EvaluateGradient %.1f ms\n", POINT_COUNT, gradientMs);
+	return failures;
+}
@@ -0,0 +1,206 @@
+#include "Benchmark.h"
+#include "CircleLOD.h"
+#include "JobSystem.h"
+#include "ParticleSystem.h"
+
+#include<cmath>
+#include<cstdio>
+#include<cstring>
+#include<vector>
+
+const unsigned int REFERENCE_CAPACITY = 300000;
+const unsigned int REFERENCE_FRAMES = 120;
+const unsigned int DETERMINISM_CAPACITY = 200000;
+const unsigned int DETERMINISM_FRAMES = 90;
+const unsigned int DETERMINISM_WORKERS = 4;
+const unsigned int TIMING_PARTICLES = 1000000;
+const unsigned int TIMING_FRAMES = 30;
+const float FRAME = 1.0f / 60.0f;
+
+// The straightforward version: one struct per particle, updated one at a time and
+// compacted by copying the survivors in order. Draws the same random numbers in the
+// same order as ParticleSystem, so the two must agree particle for particle.
+struct ReferenceParticle
+{
+	float x, y, velocityX, velocityY, age, inverseLifetime;
+};
+
+class ReferenceParticles
+{
+public:
+	std::vector<ReferenceParticle> particles;
+	ParticleEmitter emitter;
+	unsigned int capacity;
+	unsigned int randomState;
+	float emitAccumulator = 0.0f;
+
+	ReferenceParticles(unsigned int capacity, unsigned int seed)
+		: capacity(capacity), randomState(seed ? seed : 1)
+	{
+	}
+
+	float Random()
+	{
+		randomState ^= randomState << 13;
+		randomState ^= randomState >> 17;
+		randomState ^= randomState << 5;
+		return (float)(randomState >> 8) * (1.0f / 16777216.0f);
+	}
+
+	void Spawn(unsigned int count)
+	{
+		for (unsigned int i = 0; i < count && particles.size() < capacity; i++)
+		{
+			const float angle = emitter.angle + (2.0f * Random() - 1.0f) * emitter.spread;
+			const float speed = emitter.minSpeed + (emitter.maxSpeed - emitter.minSpeed) * Random();
+			const float lifetime = emitter.minLifetime + (emitter.maxLifetime - emitter.minLifetime) * Random();
+			ReferenceParticle particle = { emitter.x, emitter.y, std::cos(angle) * speed, std::sin(angle) * speed, 0.0f, 1.0f / lifetime };
+			particles.push_back(particle);
+		}
+	}
+
+	void Update(float dt)
+	{
+		emitAccumulator += emitter.rate * dt;
+		const unsigned int emit = (unsigned int)emitAccumulator;
+		emitAccumulator -= (float)emit;
+		Spawn(emit);
+
+		const float damping = std::pow(emitter.damping, dt);
+		std::vector<ReferenceParticle> survivors;
+		for (ReferenceParticle particle : particles)
+		{
+			particle.age += dt;
+			if (particle.age * particle.inverseLifetime >= 1.0f)
+				continue;
+			particle.velocityX = particle.velocityX * damping + emitter.gravityX * dt;
+			particle.velocityY = particle.velocityY * damping + emitter.gravityY * dt;
+			particle.x += particle.velocityX * dt;
+			particle.y += particle.velocityY * dt;
+			survivors.push_back(particle);
+		}
+		particles.swap(survivors);
+	}
+};
+
+static int CheckAgainstReference(JobSystem& jobs)
+{
+	ParticleSystem system(REFERENCE_CAPACITY, 7);
+	system.GetEmitter().rate = 200000.0f;
+	system.GetEmitter().x = 0.3f;
+	ReferenceParticles reference(REFERENCE_CAPACITY, 7);
+	reference.emitter = system.GetEmitter();
+
+	system.Burst(50000);
+	reference.Spawn(50000);
+	for (unsigned int frame = 0; frame < REFERENCE_FRAMES; frame++)
+	{
+		system.Update(jobs, FRAME);
+		reference.Update(FRAME);
+	}
+
+	int failures = 0;
+	const unsigned int count = system.GetCount();
+	if (count != reference.particles.size())
+		failures++;
+
+	float maxError = 0.0f;
+	// Birth order: every particle is at least as young as the one before it
+	bool birthOrder = true;
+	for (unsigned int i = 0; i < count && i < reference.particles.size(); i++)
+	{
+		const ReferenceParticle& expected = reference.particles[i];
+		maxError = std::fmax(maxError, std::fabs(system.GetX()[i] - expected.x));
+		maxError = std::fmax(maxError, std::fabs(system.GetY()[i] - expected.y));
+		maxError = std::fmax(maxError, std::fabs(system.GetAge()[i] - expected.age));
+		if (i > 0 && system.GetAge()[i] > system.GetAge()[i - 1])
+			birthOrder = false;
+	}
+	if (maxError > 1e-5f)
+		failures++;
+	if (!birthOrder)
+		failures++;
+
+	// Instances interpolate radius and color over each particle's life
+	std::vector<CircleInstance> instances(count);
+	const ParticleEmitter& emitter = system.GetEmitter();
+	bool instancesMatch = system.WriteInstances(jobs, instances.data(), count) == count;
+	for (unsigned int i = 0; i < count && i < reference.particles.size() && instancesMatch; i++)
+	{
+		const ReferenceParticle& expected = reference.particles[i];
+		const float t = expected.age * expected.inverseLifetime;
+		instancesMatch = instances[i].x == system.GetX()[i] && instances[i].y == system.GetY()[i] &&
+			std::fabs(instances[i].radius - (emitter.startRadius + (emitter.endRadius - emitter.startRadius) * t)) <= 1e-5f &&
+			std::fabs(instances[i].color[3] - (emitter.startColor[3] + (emitter.endColor[3] - emitter.startColor[3]) * t)) <= 1e-5f;
+	}
+	if (!instancesMatch || system.WriteInstances(jobs, instances.data(), 10) != 10)
+		failures++;
+
+	std::printf("%u particles after %u frames, reference %u: max error %.2g, birth order %s\n", count, REFERENCE_FRAMES,
+		(unsigned int)reference.particles.size(), maxError, birthOrder ? "kept" : "BROKEN");
+	return failures ? 1 : 0;
+}
+
+// Compaction must give the same arrays however the chunks were spread over threads
+static int CheckDeterminism(JobSystem& serial, JobSystem& parallel)
+{
+	ParticleSystem a(DETERMINISM_CAPACITY, 3), b(DETERMINISM_CAPACITY, 3);
+	a.GetEmitter().rate = b.GetEmitter().rate = 100000.0f;
+	for (unsigned int frame = 0; frame < DETERMINISM_FRAMES; frame++)
+	{
+		a.Update(serial, FRAME);
+		b.Update(parallel, FRAME);
+	}
+
+	const size_t bytes = a.GetCount() * sizeof(float);
+	const bool identical = a.GetCount() == b.GetCount() && std::memcmp(a.GetX(), b.GetX(), bytes) == 0 &&
+		std::memcmp(a.GetY(), b.GetY(), bytes) == 0 && std::memcmp(a.GetAge(), b.GetAge(), bytes) == 0;
+	std::printf("%u particles, %u frames on %u and %u threads: %s\n", a.GetCount(), DETERMINISM_FRAMES,
+		serial.GetThreadCount(), parallel.GetThreadCount(), identical ? "bit-identical" : "DIFFERENT");
+	return identical ? 0 : 1;
+}
+
+static void MeasureStages(JobSystem& jobs)
+{
+	// Lifetimes around a second at a million per second, so births and deaths balance
+	ParticleSystem system(TIMING_PARTICLES + TIMING_PARTICLES / 10, 9);
+	ParticleEmitter& emitter = system.GetEmitter();
+	emitter.minLifetime = 0.9f;
+	emitter.maxLifetime = 1.1f;
+	emitter.rate = (float)TIMING_PARTICLES;
+	system.Burst(TIMING_PARTICLES);
+	for (unsigned int frame = 0; frame < 120; frame++)
+		system.Update(jobs, FRAME);
+
+	std::vector<CircleInstance> instances(system.GetCapacity());
+	ParticleStats total;
+	for (unsigned int frame = 0; frame < TIMING_FRAMES; frame++)
+	{
+		system.Update(jobs, FRAME);
+		system.WriteInstances(jobs, instances.data(), system.GetCapacity());
+		const ParticleStats& stats = system.GetStats();
+		total.EmitMs += stats.EmitMs;
+		total.SimulateMs += stats.SimulateMs;
+		total.CompactMs += stats.CompactMs;
+		total.WriteMs += stats.WriteMs;
+		total.Killed += stats.Killed;
+	}
+
+	std::printf("%u particles on %u threads, per frame: emit %.2f ms, compact %.2f ms, simulate %.2f ms, write %.2f ms (%u killed)\n",
+		system.GetCount(), jobs.GetThreadCount(), total.EmitMs / TIMING_FRAMES, total.CompactMs / TIMING_FRAMES,
+		total.SimulateMs / TIMING_FRAMES, total.WriteMs / TIMING_FRAMES, total.Killed / TIMING_FRAMES);
+}
+
+int RunParticleBenchmark()
+{
+	JobSystem serial(0);
+	JobSystem parallel(DETERMINISM_WORKERS);
+
+	int failures = 0;
+	failures += CheckAgainstReference(parallel);
+	failures += CheckDeterminism(serial, parallel);
+
+	JobSystem jobs;
+	MeasureStages(jobs);
+	return failures;
+}
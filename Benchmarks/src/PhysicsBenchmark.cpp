@@ -0,0 +1,153 @@
+#include "Benchmark.h"
+#include "CirclePhysics.h"
+#include "JobSystem.h"
+#include "Scene.h"
+
+#include<algorithm>
+#include<cmath>
+#include<cstdio>
+#include<cstdlib>
+#include<cstring>
+#include<utility>
+#include<vector>
+
+const unsigned int CONTACT_COUNT = 8000;
+const unsigned int DETERMINISM_COUNT = 50000;
+const unsigned int DETERMINISM_STEPS = 30;
+const unsigned int DETERMINISM_WORKERS = 4;
+const unsigned int TIMING_COUNT = 200000;
+const unsigned int TIMING_STEPS = 20;
+const float STEP = 1.0f / 60.0f;
+
+static float RandomFloat(float min, float max)
+{
+	return min + (max - min) * (std::rand() / (float)RAND_MAX);
+}
+
+// count small circles drifting at random in [-halfWidth, halfWidth], the same for a given seed
+static void FillScene(Scene& scene, unsigned int count, float halfWidth, unsigned int seed)
+{
+	const float white[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	std::srand(seed);
+	scene.Clear();
+	scene.Reserve(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const float x = RandomFloat(-halfWidth, halfWidth), y = RandomFloat(-halfWidth, halfWidth);
+		const float radius = RandomFloat(0.002f, 0.006f);
+		scene.Create(x, y, radius, white, RandomFloat(-0.1f, 0.1f), RandomFloat(-0.1f, 0.1f));
+	}
+}
+
+// The sweep must find exactly the pairs an all-pairs test finds
+static int CheckContacts(JobSystem& jobs)
+{
+	// Contacts are found before they are resolved, so the brute force runs on an untouched copy
+	Scene scene, reference;
+	FillScene(scene, CONTACT_COUNT, 0.3f, 1);
+	FillScene(reference, CONTACT_COUNT, 0.3f, 1);
+
+	// No time step, so nothing moves before the sweep
+	CirclePhysics physics;
+	physics.SetIterations(0);
+	physics.Step(jobs, scene, 0.0f);
+
+	int failures = 0;
+	std::vector<std::pair<unsigned int, unsigned int>> found;
+	for (const CircleContact& contact : physics.GetContacts())
+	{
+		found.push_back(std::make_pair(std::min(contact.a, contact.b), std::max(contact.a, contact.b)));
+		const float normalLength = contact.normalX * contact.normalX + contact.normalY * contact.normalY;
+		if (contact.depth <= 0.0f || std::fabs(normalLength - 1.0f) > 1e-4f)
+			failures++;
+	}
+	std::sort(found.begin(), found.end());
+
+	std::vector<std::pair<unsigned int, unsigned int>> expected;
+	const float* x = reference.GetX();
+	const float* y = reference.GetY();
+	const float* radius = reference.GetRadius();
+	for (unsigned int i = 0; i < reference.GetCount(); i++)
+	{
+		for (unsigned int j = i + 1; j < reference.GetCount(); j++)
+		{
+			const float dx = x[j] - x[i], dy = y[j] - y[i], reach = radius[i] + radius[j];
+			if (dx * dx + dy * dy < reach * reach)
+				expected.push_back(std::make_pair(i, j));
+		}
+	}
+
+	if (found != expected)
+		failures++;
+	std::printf("%u circles: %u contacts, brute force %u\n", CONTACT_COUNT, (unsigned int)found.size(), (unsigned int)expected.size());
+	return failures ? 1 : 0;
+}
+
+// Contact resolution must not depend on how the work was split up
+static int CheckDeterminism(JobSystem& serial, JobSystem& parallel)
+{
+	Scene a, b;
+	FillScene(a, DETERMINISM_COUNT, 0.8f, 3);
+	FillScene(b, DETERMINISM_COUNT, 0.8f, 3);
+
+	const AABB bounds = { -1.0f, -1.0f, 1.0f, 1.0f };
+	CirclePhysics physicsA, physicsB;
+	physicsA.SetBounds(bounds);
+	physicsB.SetBounds(bounds);
+	for (unsigned int step = 0; step < DETERMINISM_STEPS; step++)
+	{
+		physicsA.Step(serial, a, STEP);
+		physicsB.Step(parallel, b, STEP);
+	}
+
+	const size_t bytes = a.GetCount() * sizeof(float);
+	const bool identical = std::memcmp(a.GetX(), b.GetX(), bytes) == 0 && std::memcmp(a.GetY(), b.GetY(), bytes) == 0 &&
+		std::memcmp(a.GetVelocityX(), b.GetVelocityX(), bytes) == 0 && std::memcmp(a.GetVelocityY(), b.GetVelocityY(), bytes) == 0;
+	std::printf("%u circles, %u steps on %u and %u threads: %s (%u contacts in the last step)\n", DETERMINISM_COUNT, DETERMINISM_STEPS,
+		serial.GetThreadCount(), parallel.GetThreadCount(), identical ? "bit-identical" : "DIFFERENT", physicsA.GetStats().Contacts);
+	return identical ? 0 : 1;
+}
+
+static void MeasureStages(JobSystem& jobs)
+{
+	// About 30% of the area covered, so contacts are common but not everywhere
+	const float halfWidth = std::sqrt(TIMING_COUNT * 3.14159f * 1.9e-5f / 0.3f) / 2.0f;
+	Scene scene;
+	FillScene(scene, TIMING_COUNT, halfWidth, 4);
+	CirclePhysics physics;
+	physics.SetBounds(AABB{ -halfWidth, -halfWidth, halfWidth, halfWidth });
+
+	// Let the first, deepest overlaps settle
+	for (unsigned int step = 0; step < 5; step++)
+		physics.Step(jobs, scene, STEP);
+
+	PhysicsStats total;
+	for (unsigned int step = 0; step < TIMING_STEPS; step++)
+	{
+		physics.Step(jobs, scene, STEP);
+		const PhysicsStats& stats = physics.GetStats();
+		total.IntegrateMs += stats.IntegrateMs;
+		total.SortMs += stats.SortMs;
+		total.SweepMs += stats.SweepMs;
+		total.SolveMs += stats.SolveMs;
+	}
+
+	const float stepMs = (total.IntegrateMs + total.SortMs + total.SweepMs + total.SolveMs) / TIMING_STEPS;
+	std::printf("%u circles on %u threads: %.2f ms per step (integrate %.2f, sort %.2f, sweep %.2f, solve %.2f), %u contacts\n",
+		TIMING_COUNT, jobs.GetThreadCount(), stepMs, total.IntegrateMs / TIMING_STEPS, total.SortMs / TIMING_STEPS,
+		total.SweepMs / TIMING_STEPS, total.SolveMs / TIMING_STEPS, physics.GetStats().Contacts);
+}
+
+int RunPhysicsBenchmark()
+{
+	JobSystem serial(0);
+	JobSystem parallel(DETERMINISM_WORKERS);
+
+	int failures = 0;
+	failures += CheckContacts(parallel);
+	failures += CheckDeterminism(serial, parallel);
+
+	JobSystem jobs;
+	MeasureStages(jobs);
+	return failures;
+}
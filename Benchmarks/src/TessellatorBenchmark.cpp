@@ -0,0 +1,79 @@
+#include "Benchmark.h"
+#include "Tessellator.h"
+
+#include<cmath>
+#include<cstdio>
+#include<vector>
+
+const unsigned int CIRCLE_COUNT = 1000000;
+const unsigned int ARC_COUNT = 100000;
+const unsigned int SEGMENTS = 120;
+
+// GetPositions as it was before the Tessellator: pi rounded to 3.142, cos/sin per point
+// in float-to-double conversions, and a vector grown one push_back at a time
+static std::vector<float> LegacyGetPositions(float x, float y, float radius, unsigned int vertex_count)
+{
+	float theta = ((360.0 / (float)vertex_count) * 3.142) / 180.0;
+	std::vector<float> positions = { x, y, (x + radius), y };
+
+	for (unsigned int i = 1; i <= vertex_count; i++)
+	{
+		positions.push_back(x + (radius * cos(theta * i)));
+		positions.push_back(y + (radius * sin(theta * i)));
+	}
+	positions.push_back((x + radius));
+	positions.push_back(y);
+	return positions;
+}
+
+int RunTessellatorBenchmark()
+{
+	int failures = 0;
+	// Keeps the optimizer from dropping the work
+	double sink = 0.0;
+
+	BenchmarkClock::time_point start = BenchmarkClock::now();
+	for (unsigned int i = 0; i < CIRCLE_COUNT; i++)
+	{
+		std::vector<float> positions = LegacyGetPositions(i * 1e-6f, 0.5f, 0.2f, SEGMENTS);
+		sink += positions[7];
+	}
+	const double legacyMs = MillisecondsSince(start);
+
+	std::vector<float> out(GetCircleVertexCount(SEGMENTS) * 2);
+	start = BenchmarkClock::now();
+	for (unsigned int i = 0; i < CIRCLE_COUNT; i++)
+	{
+		TessellateCircle(out.data(), i * 1e-6f, 0.5f, 0.2f, SEGMENTS);
+		sink += out[7];
+	}
+	const double tableMs = MillisecondsSince(start);
+
+	// Every point of the last circle against double precision cos/sin
+	const double cx = (CIRCLE_COUNT - 1) * 1e-6f;
+	double maxError = 0.0;
+	for (unsigned int i = 0; i <= SEGMENTS; i++)
+	{
+		const double angle = 2.0 * 3.14159265358979323846 * i / SEGMENTS;
+		maxError = std::fmax(maxError, std::fabs(out[2 + 2 * i] - (cx + 0.2 * std::cos(angle))));
+		maxError = std::fmax(maxError, std::fabs(out[3 + 2 * i] - (0.5 + 0.2 * std::sin(angle))));
+	}
+	if (maxError > 1e-6)
+		failures++;
+
+	// A sweep that changes every call, the case a per-angle cache would grow without bound
+	start = BenchmarkClock::now();
+	for (unsigned int i = 0; i < ARC_COUNT; i++)
+	{
+		TessellateArc(out.data(), 0.0f, 0.0f, 0.2f, 0.0f, 1e-5f * (i + 1), SEGMENTS);
+		sink += out[7];
+	}
+	const double arcMs = MillisecondsSince(start);
+
+	std::printf("%u circles of %u segments: legacy GetPositions %.1f ms, TessellateCircle %.1f ms (%.1fx)\n",
+		CIRCLE_COUNT, SEGMENTS, legacyMs, tableMs, legacyMs / tableMs);
+	std::printf("max error against exact cos/sin: %.2g\n", maxError);
+	std::printf("%u arcs, each with new angles: %.1f ms\n", ARC_COUNT, arcMs);
+	std::printf("(checksum %g)\n", sink);
+	return failures;
+}
@@ -0,0 +1,75 @@
+#shader vertex
+#version 430 core
+
+layout(location = 0) in vec4 position;
+
+// AnimationKeyframe and AnimationSet's tracks
+struct Keyframe
+{
+   float time;
+   // 0 = linear, 1 = step
+   uint interpolation;
+   vec2 offset;
+   vec4 color;
+};
+
+struct Track
+{
+   uint firstKeyframe;
+   uint keyframeCount;
+   float duration;
+   uint loop;
+};
+
+layout(std430, binding = 4) readonly buffer Keyframes { Keyframe k_Keyframes[]; };
+layout(std430, binding = 5) readonly buffer Tracks { Track t_Tracks[]; };
+
+// Basic.shader's uniforms: the animated offset is added, the animated color tinted
+uniform vec2 u_Offset;
+uniform vec4 u_Color;
+uniform float u_Time;
+uniform uint u_Track;
+
+out vec4 v_Color;
+
+void main()
+{
+   // Same steps as AnimationSet::Evaluate
+   Track track = t_Tracks[u_Track];
+   float time = u_Time;
+   if (track.loop != 0u && track.duration > 0.0)
+      time = time - track.duration * floor(time / track.duration);
+
+   // First keyframe after time
+   uint low = 0u, high = track.keyframeCount;
+   while (low < high)
+   {
+      uint middle = (low + high) / 2u;
+      if (k_Keyframes[track.firstKeyframe + middle].time <= time)
+         low = middle + 1u;
+      else
+         high = middle;
+   }
+
+   Keyframe a = k_Keyframes[track.firstKeyframe + (low > 0u ? low - 1u : 0u)];
+   Keyframe b = k_Keyframes[track.firstKeyframe + min(low, track.keyframeCount - 1u)];
+   float s = 0.0;
+   if (low > 0u && low < track.keyframeCount && a.interpolation == 0u)
+      s = (time - a.time) / (b.time - a.time);
+
+   vec2 offset = a.offset + (b.offset - a.offset) * s;
+   gl_Position = vec4(position.xy + u_Offset + offset, position.z, position.w);
+   v_Color = u_Color * (a.color + (b.color - a.color) * s);
+}
+
+#shader fragment
+#version 430 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+   color = v_Color;
+}
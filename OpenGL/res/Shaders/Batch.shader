@@ -0,0 +1,27 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+// Per-draw data, advanced through baseInstance (see IndirectDrawBuilder)
+layout(location = 1) in vec2 i_Offset;
+layout(location = 2) in vec4 i_Color;
+
+out vec4 v_Color;
+
+void main()
+{
+   gl_Position = vec4(position.x + i_Offset.x, position.y + i_Offset.y, position.z, position.w);
+   v_Color = i_Color;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+   color = v_Color;
+}
@@ -0,0 +1,28 @@
+#shader vertex
+#version 330 core
+
+// Unit circle from CircleLODMeshes
+layout(location = 0) in vec4 position;
+// Per-instance: x, y, radius
+layout(location = 1) in vec3 i_Circle;
+layout(location = 2) in vec4 i_Color;
+
+out vec4 v_Color;
+
+void main()
+{
+   gl_Position = vec4(i_Circle.xy + position.xy * i_Circle.z, 0.0, 1.0);
+   v_Color = i_Color;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+   color = v_Color;
+}
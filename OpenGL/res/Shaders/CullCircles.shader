@@ -0,0 +1,57 @@
+#shader compute
+#version 430 core
+
+layout(local_size_x = 256) in;
+
+// CircleInstance records, 7 floats each: x, y, radius, r, g, b, a
+layout(std430, binding = 0) readonly buffer Instances { float i_Instances[]; };
+layout(std430, binding = 1) writeonly buffer Visible { float o_Visible[]; };
+// DrawElementsIndirectCommand; instanceCount is the append cursor
+layout(std430, binding = 2) buffer Command
+{
+   uint count;
+   uint instanceCount;
+   uint firstIndex;
+   int baseVertex;
+   uint baseInstance;
+};
+
+// minX, minY, maxX, maxY
+uniform vec4 u_View;
+uniform uint u_Count;
+
+shared uint s_Count;
+shared uint s_Base;
+
+void main()
+{
+   uint i = gl_GlobalInvocationID.x;
+   if (gl_LocalInvocationIndex == 0u)
+      s_Count = 0u;
+   barrier();
+
+   bool visible = false;
+   if (i < u_Count)
+   {
+      float x = i_Instances[i * 7u];
+      float y = i_Instances[i * 7u + 1u];
+      float r = i_Instances[i * 7u + 2u];
+      visible = x + r >= u_View.x && x - r <= u_View.z && y + r >= u_View.y && y - r <= u_View.w;
+   }
+
+   // Reserve the group's survivors with one global atomic instead of one each
+   uint local = 0u;
+   if (visible)
+      local = atomicAdd(s_Count, 1u);
+   barrier();
+   if (gl_LocalInvocationIndex == 0u && s_Count > 0u)
+      s_Base = atomicAdd(instanceCount, s_Count);
+   barrier();
+
+   if (visible)
+   {
+      uint src = i * 7u, dst = (s_Base + local) * 7u;
+      for (uint k = 0u; k < 7u; k++)
+         o_Visible[dst + k] = i_Instances[src + k];
+   }
+}
@@ -0,0 +1,38 @@
+#shader vertex
+#version 330 core
+
+// Unit circle from CircleLODMeshes
+layout(location = 0) in vec4 position;
+// Per-instance, straight from the simulated GPUParticle buffer
+layout(location = 1) in vec4 i_Motion;
+// Age, lifetime
+layout(location = 2) in vec2 i_Life;
+
+out vec4 v_Color;
+
+// Start and end
+uniform vec2 u_Radius;
+uniform vec4 u_StartColor;
+uniform vec4 u_EndColor;
+
+void main()
+{
+   // Unborn particles collapse to a point and draw nothing
+   bool alive = i_Life.x >= 0.0 && i_Life.x < i_Life.y;
+   float t = alive ? i_Life.x / i_Life.y : 0.0;
+   float radius = alive ? mix(u_Radius.x, u_Radius.y, t) : 0.0;
+   gl_Position = vec4(i_Motion.xy + position.xy * radius, 0.0, 1.0);
+   v_Color = mix(u_StartColor, u_EndColor, t);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+   color = v_Color;
+}
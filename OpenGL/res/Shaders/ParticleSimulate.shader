@@ -0,0 +1,72 @@
+#shader compute
+#version 430 core
+
+layout(local_size_x = 256) in;
+
+// GPUParticle records, 6 floats each: x, y, velocity x, velocity y, age, lifetime.
+// Keep in step with ParticleUpdate.shader.
+layout(std430, binding = 0) readonly buffer Source { float i_Particles[]; };
+layout(std430, binding = 1) writeonly buffer Destination { float o_Particles[]; };
+
+uniform uint u_Count;
+uniform float u_DeltaTime;
+uniform uint u_StepSeed;
+uniform vec2 u_Emitter;
+// Angle and spread in radians
+uniform vec2 u_Direction;
+// Minimum and range
+uniform vec2 u_Speed;
+uniform vec2 u_LifetimeRange;
+// Velocity kept, and gravity added, over one step
+uniform float u_Damping;
+uniform vec2 u_Gravity;
+
+// PCG output permutation; the same integer math as the CPU reference
+uint Hash(uint x)
+{
+   uint state = x * 747796405u + 2891336453u;
+   uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+   return (word >> 22u) ^ word;
+}
+
+// [0, 1) from the top 24 bits, exact in a float
+float Unit(uint x)
+{
+   return float(x >> 8u) * (1.0 / 16777216.0);
+}
+
+void main()
+{
+   uint i = gl_GlobalInvocationID.x;
+   if (i >= u_Count)
+      return;
+
+   uint base = i * 6u;
+   vec2 position = vec2(i_Particles[base], i_Particles[base + 1u]);
+   vec2 velocity = vec2(i_Particles[base + 2u], i_Particles[base + 3u]);
+   float age = i_Particles[base + 4u] + u_DeltaTime;
+   float lifetime = i_Particles[base + 5u];
+
+   if (age >= lifetime)
+   {
+      uint h = Hash(u_StepSeed ^ i);
+      float angle = u_Direction.x + (2.0 * Unit(Hash(h)) - 1.0) * u_Direction.y;
+      float speed = u_Speed.x + u_Speed.y * Unit(Hash(h + 1u));
+      position = u_Emitter;
+      velocity = vec2(cos(angle), sin(angle)) * speed;
+      age = 0.0;
+      lifetime = u_LifetimeRange.x + u_LifetimeRange.y * Unit(Hash(h + 2u));
+   }
+   else if (age >= 0.0)
+   {
+      velocity = velocity * u_Damping + u_Gravity;
+      position = position + velocity * u_DeltaTime;
+   }
+
+   o_Particles[base] = position.x;
+   o_Particles[base + 1u] = position.y;
+   o_Particles[base + 2u] = velocity.x;
+   o_Particles[base + 3u] = velocity.y;
+   o_Particles[base + 4u] = age;
+   o_Particles[base + 5u] = lifetime;
+}
@@ -0,0 +1,65 @@
+#shader vertex
+#version 330 core
+#feedback o_Position o_Velocity o_Age o_Lifetime
+
+// One GPUParticle per vertex, drawn as points with rasterization discarded; the outputs
+// are captured into the other buffer. Keep in step with ParticleSimulate.shader.
+layout(location = 0) in vec2 i_Position;
+layout(location = 1) in vec2 i_Velocity;
+layout(location = 2) in float i_Age;
+layout(location = 3) in float i_Lifetime;
+
+out vec2 o_Position;
+out vec2 o_Velocity;
+out float o_Age;
+out float o_Lifetime;
+
+uniform float u_DeltaTime;
+uniform uint u_StepSeed;
+uniform vec2 u_Emitter;
+// Angle and spread in radians
+uniform vec2 u_Direction;
+// Minimum and range
+uniform vec2 u_Speed;
+uniform vec2 u_LifetimeRange;
+// Velocity kept, and gravity added, over one step
+uniform float u_Damping;
+uniform vec2 u_Gravity;
+
+// PCG output permutation; the same integer math as the CPU reference
+uint Hash(uint x)
+{
+   uint state = x * 747796405u + 2891336453u;
+   uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+   return (word >> 22u) ^ word;
+}
+
+// [0, 1) from the top 24 bits, exact in a float
+float Unit(uint x)
+{
+   return float(x >> 8u) * (1.0 / 16777216.0);
+}
+
+void main()
+{
+   o_Position = i_Position;
+   o_Velocity = i_Velocity;
+   o_Age = i_Age + u_DeltaTime;
+   o_Lifetime = i_Lifetime;
+
+   if (o_Age >= o_Lifetime)
+   {
+      uint h = Hash(u_StepSeed ^ uint(gl_VertexID));
+      float angle = u_Direction.x + (2.0 * Unit(Hash(h)) - 1.0) * u_Direction.y;
+      float speed = u_Speed.x + u_Speed.y * Unit(Hash(h + 1u));
+      o_Position = u_Emitter;
+      o_Velocity = vec2(cos(angle), sin(angle)) * speed;
+      o_Age = 0.0;
+      o_Lifetime = u_LifetimeRange.x + u_LifetimeRange.y * Unit(Hash(h + 2u));
+   }
+   else if (o_Age >= 0.0)
+   {
+      o_Velocity = o_Velocity * u_Damping + u_Gravity;
+      o_Position = o_Position + o_Velocity * u_DeltaTime;
+   }
+}
@@ -0,0 +1,28 @@
+#shader vertex
+#version 330 core
+
+// Same inputs as Circle.shader; instance i gets ID u_FirstID + i
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec3 i_Circle;
+
+uniform uint u_FirstID;
+
+flat out uint v_ID;
+
+void main()
+{
+   gl_Position = vec4(i_Circle.xy + position.xy * i_Circle.z, 0.0, 1.0);
+   v_ID = u_FirstID + uint(gl_InstanceID);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out uint id;
+
+flat in uint v_ID;
+
+void main()
+{
+   id = v_ID;
+}
@@ -0,0 +1,24 @@
+#shader vertex
+#version 330 core
+
+// Same inputs as Basic.shader, so any mesh drawn with it can be picked
+layout(location = 0) in vec4 position;
+uniform vec2 u_Offset;
+
+void main()
+{
+   gl_Position = vec4(position.x + u_Offset.x, position.y + u_Offset.y, position.z, position.w);
+}
+
+#shader fragment
+#version 330 core
+
+// Written to the integer attachment of a PickingBuffer; 0 means nothing
+layout(location = 0) out uint id;
+
+uniform uint u_ID;
+
+void main()
+{
+   id = u_ID;
+}
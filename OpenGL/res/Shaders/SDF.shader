@@ -0,0 +1,61 @@
+#shader vertex
+#version 330 core
+
+// Quad corners in [-1, 1]
+layout(location = 0) in vec4 position;
+
+uniform vec2 u_Offset;
+// Half extent of the shape in clip space
+uniform vec2 u_Size;
+// One pixel in clip space, the quad grows by this so the antialiased edge is not clipped
+uniform vec2 u_PixelSize;
+
+out vec2 v_Local;
+
+void main()
+{
+   v_Local = position.xy * (u_Size + u_PixelSize);
+   gl_Position = vec4(v_Local + u_Offset, 0.0, 1.0);
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_Local;
+
+uniform vec4 u_Color;
+uniform vec2 u_Size;
+// 0 = circle, 1 = ring, 2 = rounded rectangle
+uniform int u_Shape;
+uniform float u_Thickness;
+uniform float u_CornerRadius;
+
+float CircleDistance(vec2 p, float r)
+{
+   return length(p) - r;
+}
+
+float RoundedRectDistance(vec2 p, vec2 halfSize, float r)
+{
+   vec2 q = abs(p) - (halfSize - vec2(r));
+   return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - r;
+}
+
+void main()
+{
+   float d;
+   if (u_Shape == 0)
+      d = CircleDistance(v_Local, u_Size.x);
+   else if (u_Shape == 1)
+      d = abs(CircleDistance(v_Local, u_Size.x - u_Thickness * 0.5)) - u_Thickness * 0.5;
+   else
+      d = RoundedRectDistance(v_Local, u_Size, u_CornerRadius);
+
+   // Coverage over one pixel's worth of distance
+   float alpha = clamp(0.5 - d / fwidth(d), 0.0, 1.0);
+   if (alpha <= 0.0)
+      discard;
+   color = vec4(u_Color.rgb, u_Color.a * alpha);
+}
@@ -0,0 +1,297 @@
+#include "AABBTree.h"
+#include "JobSystem.h"
+#include "Renderer.h"
+
+#include<algorithm>
+
+AABBTree::AABBTree(float margin)
+	: m_Root(Null), m_FreeList(Null), m_ProxyCount(0), m_Margin(margin)
+{
+}
+
+int AABBTree::AllocateNode()
+{
+	if (m_FreeList == Null)
+	{
+		Node node;
+		node.parent = Null;
+		node.height = -1;
+		m_Nodes.push_back(node);
+		m_FreeList = (int)m_Nodes.size() - 1;
+	}
+
+	int index = m_FreeList;
+	Node& node = m_Nodes[index];
+	m_FreeList = node.parent;
+	node.parent = Null;
+	node.child1 = node.child2 = Null;
+	node.height = 0;
+	node.userData = 0;
+	return index;
+}
+
+void AABBTree::FreeNode(int node)
+{
+	m_Nodes[node].parent = m_FreeList;
+	m_Nodes[node].height = -1;
+	m_FreeList = node;
+}
+
+int AABBTree::CreateProxy(const AABB& box, unsigned int userData)
+{
+	int proxy = AllocateNode();
+	m_Nodes[proxy].box = AABB{ box.minX - m_Margin, box.minY - m_Margin, box.maxX + m_Margin, box.maxY + m_Margin };
+	m_Nodes[proxy].userData = userData;
+	InsertLeaf(proxy);
+	m_ProxyCount++;
+	return proxy;
+}
+
+void AABBTree::DestroyProxy(int proxy)
+{
+	ASSERT(proxy >= 0 && proxy < (int)m_Nodes.size() && m_Nodes[proxy].IsLeaf() && m_Nodes[proxy].height == 0);
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	m_ProxyCount--;
+}
+
+bool AABBTree::MoveProxy(int proxy, const AABB& box)
+{
+	if (m_Nodes[proxy].box.Contains(box))
+		return false;
+
+	RemoveLeaf(proxy);
+	m_Nodes[proxy].box = AABB{ box.minX - m_Margin, box.minY - m_Margin, box.maxX + m_Margin, box.maxY + m_Margin };
+	InsertLeaf(proxy);
+	return true;
+}
+
+void AABBTree::InsertLeaf(int leaf)
+{
+	if (m_Root == Null)
+	{
+		m_Root = leaf;
+		m_Nodes[leaf].parent = Null;
+		return;
+	}
+
+	// Walk down to the sibling that makes the new parent cheapest, by perimeter
+	const AABB leafBox = m_Nodes[leaf].box;
+	int index = m_Root;
+	while (!m_Nodes[index].IsLeaf())
+	{
+		const Node& node = m_Nodes[index];
+		float perimeter = node.box.GetPerimeter();
+		float combined = AABB::Union(node.box, leafBox).GetPerimeter();
+
+		// Pairing with this node, versus pushing the leaf further down
+		float cost = 2.0f * combined;
+		float inheritance = 2.0f * (combined - perimeter);
+
+		float childCost[2];
+		const int children[2] = { node.child1, node.child2 };
+		for (int i = 0; i < 2; i++)
+		{
+			const Node& child = m_Nodes[children[i]];
+			float grown = AABB::Union(leafBox, child.box).GetPerimeter();
+			childCost[i] = (child.IsLeaf() ? grown : grown - child.box.GetPerimeter()) + inheritance;
+		}
+
+		if (cost < childCost[0] && cost < childCost[1])
+			break;
+		index = childCost[0] < childCost[1] ? children[0] : children[1];
+	}
+
+	const int sibling = index;
+	const int oldParent = m_Nodes[sibling].parent;
+	const int newParent = AllocateNode();
+	m_Nodes[newParent].parent = oldParent;
+	m_Nodes[newParent].box = AABB::Union(leafBox, m_Nodes[sibling].box);
+	m_Nodes[newParent].height = m_Nodes[sibling].height + 1;
+	m_Nodes[newParent].child1 = sibling;
+	m_Nodes[newParent].child2 = leaf;
+	m_Nodes[sibling].parent = newParent;
+	m_Nodes[leaf].parent = newParent;
+
+	if (oldParent == Null)
+		m_Root = newParent;
+	else if (m_Nodes[oldParent].child1 == sibling)
+		m_Nodes[oldParent].child1 = newParent;
+	else
+		m_Nodes[oldParent].child2 = newParent;
+
+	Refit(m_Nodes[leaf].parent);
+}
+
+void AABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == m_Root)
+	{
+		m_Root = Null;
+		return;
+	}
+
+	// The sibling takes the parent's place
+	const int parent = m_Nodes[leaf].parent;
+	const int grandParent = m_Nodes[parent].parent;
+	const int sibling = m_Nodes[parent].child1 == leaf ? m_Nodes[parent].child2 : m_Nodes[parent].child1;
+
+	m_Nodes[sibling].parent = grandParent;
+	FreeNode(parent);
+
+	if (grandParent == Null)
+	{
+		m_Root = sibling;
+		return;
+	}
+
+	if (m_Nodes[grandParent].child1 == parent)
+		m_Nodes[grandParent].child1 = sibling;
+	else
+		m_Nodes[grandParent].child2 = sibling;
+	Refit(grandParent);
+}
+
+void AABBTree::Refit(int node)
+{
+	for (int index = node; index != Null; index = m_Nodes[index].parent)
+	{
+		index = Balance(index);
+
+		Node& current = m_Nodes[index];
+		const Node& child1 = m_Nodes[current.child1];
+		const Node& child2 = m_Nodes[current.child2];
+		current.height = 1 + (child1.height > child2.height ? child1.height : child2.height);
+		current.box = AABB::Union(child1.box, child2.box);
+	}
+}
+
+int AABBTree::Balance(int iA)
+{
+	Node& A = m_Nodes[iA];
+	if (A.IsLeaf() || A.height < 2)
+		return iA;
+
+	const int iB = A.child1, iC = A.child2;
+	Node& B = m_Nodes[iB];
+	Node& C = m_Nodes[iC];
+	const int balance = C.height - B.height;
+	if (balance >= -1 && balance <= 1)
+		return iA;
+
+	// Rotate the taller child (up) above A; A keeps the other child and up's shorter child
+	const int iUp = balance > 1 ? iC : iB;
+	Node& up = m_Nodes[iUp];
+	Node& other = balance > 1 ? B : C;
+	const int iTall = m_Nodes[up.child1].height > m_Nodes[up.child2].height ? up.child1 : up.child2;
+	const int iShort = iTall == up.child1 ? up.child2 : up.child1;
+
+	up.parent = A.parent;
+	A.parent = iUp;
+	if (up.parent == Null)
+		m_Root = iUp;
+	else if (m_Nodes[up.parent].child1 == iA)
+		m_Nodes[up.parent].child1 = iUp;
+	else
+		m_Nodes[up.parent].child2 = iUp;
+
+	up.child1 = iA;
+	up.child2 = iTall;
+	if (balance > 1)
+		A.child2 = iShort;
+	else
+		A.child1 = iShort;
+	m_Nodes[iShort].parent = iA;
+
+	const Node& shorter = m_Nodes[iShort];
+	const Node& taller = m_Nodes[iTall];
+	A.box = AABB::Union(other.box, shorter.box);
+	A.height = 1 + (other.height > shorter.height ? other.height : shorter.height);
+	up.box = AABB::Union(A.box, taller.box);
+	up.height = 1 + (A.height > taller.height ? A.height : taller.height);
+	return iUp;
+}
+
+void AABBTree::QuerySubtree(int root, const AABB& box, std::vector<unsigned int>& out) const
+{
+	// Explicit stack; the tree stays balanced, so 64 levels is plenty before it has to grow
+	std::vector<int> stack;
+	stack.reserve(64);
+	stack.push_back(root);
+
+	while (!stack.empty())
+	{
+		const Node& node = m_Nodes[stack.back()];
+		stack.pop_back();
+		if (!node.box.Overlaps(box))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			out.push_back(node.userData);
+		}
+		else
+		{
+			stack.push_back(node.child1);
+			stack.push_back(node.child2);
+		}
+	}
+}
+
+void AABBTree::Query(const AABB& box, std::vector<unsigned int>& out) const
+{
+	if (m_Root != Null)
+		QuerySubtree(m_Root, box, out);
+}
+
+void AABBTree::QueryParallel(JobSystem& jobs, const AABB& box, std::vector<unsigned int>& out) const
+{
+	if (m_Root == Null)
+		return;
+
+	// Expand the overlapping part of the top of the tree breadth-first until there are
+	// a few subtrees per thread; leaves met on the way are hits already
+	const size_t wanted = jobs.GetThreadCount() * 8;
+	std::vector<int> frontier(1, m_Root), next;
+	std::vector<unsigned int> shallowHits;
+	while (!frontier.empty() && frontier.size() < wanted)
+	{
+		next.clear();
+		for (int index : frontier)
+		{
+			const Node& node = m_Nodes[index];
+			if (!node.box.Overlaps(box))
+				continue;
+			if (node.IsLeaf())
+			{
+				shallowHits.push_back(node.userData);
+				continue;
+			}
+			next.push_back(node.child1);
+			next.push_back(node.child2);
+		}
+		frontier.swap(next);
+	}
+
+	const unsigned int subtrees = (unsigned int)frontier.size();
+	std::vector<std::vector<unsigned int>> hits(subtrees);
+	jobs.ParallelFor(subtrees, 1, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+			QuerySubtree(frontier[i], box, hits[i]);
+	});
+
+	// Exclusive scan of the hit counts, then every subtree copies into its own range
+	std::vector<size_t> offsets(subtrees + 1);
+	offsets[0] = out.size() + shallowHits.size();
+	for (unsigned int i = 0; i < subtrees; i++)
+		offsets[i + 1] = offsets[i] + hits[i].size();
+
+	out.insert(out.end(), shallowHits.begin(), shallowHits.end());
+	out.resize(offsets[subtrees]);
+	jobs.ParallelFor(subtrees, 0, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+			std::copy(hits[i].begin(), hits[i].end(), out.begin() + offsets[i]);
+	});
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include<vector>
+
+class JobSystem;
+
+struct AABB
+{
+	float minX, minY, maxX, maxY;
+
+	inline bool Overlaps(const AABB& other) const
+	{
+		return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+	}
+	inline bool Contains(const AABB& other) const
+	{
+		return minX <= other.minX && minY <= other.minY && other.maxX <= maxX && other.maxY <= maxY;
+	}
+	inline float GetPerimeter() const { return 2.0f * ((maxX - minX) + (maxY - minY)); }
+
+	static inline AABB Union(const AABB& a, const AABB& b)
+	{
+		return AABB{ a.minX < b.minX ? a.minX : b.minX, a.minY < b.minY ? a.minY : b.minY,
+			a.maxX > b.maxX ? a.maxX : b.maxX, a.maxY > b.maxY ? a.maxY : b.maxY };
+	}
+};
+
+// Dynamic bounding volume tree over 2D boxes, built incrementally: leaves are inserted
+// where they grow the tree's surface least and rotations keep it balanced. Leaves store
+// a box enlarged by a margin, so an object that moves a little needs no update at all
+// and one that leaves its box is reinserted on its own, without a rebuild.
+class AABBTree
+{
+private:
+	static const int Null = -1;
+
+	struct Node
+	{
+		AABB box;
+		// Parent while in the tree, next free node while on the free list
+		int parent;
+		int child1, child2;
+		// Leaf = 0, free = -1
+		int height;
+		unsigned int userData;
+
+		inline bool IsLeaf() const { return child1 == Null; }
+	};
+
+	std::vector<Node> m_Nodes;
+	int m_Root;
+	int m_FreeList;
+	unsigned int m_ProxyCount;
+	float m_Margin;
+
+public:
+	explicit AABBTree(float margin = 0.01f);
+
+	// Returns a proxy ID, stable until DestroyProxy
+	int CreateProxy(const AABB& box, unsigned int userData);
+	void DestroyProxy(int proxy);
+	// Returns true if the proxy left its enlarged box and was reinserted
+	bool MoveProxy(int proxy, const AABB& box);
+
+	// Appends the user data of every proxy whose enlarged box overlaps box
+	void Query(const AABB& box, std::vector<unsigned int>& out) const;
+	// Same result as Query (order aside), with the subtrees under the view split across
+	// the job system and the hits packed into out in one pass
+	void QueryParallel(JobSystem& jobs, const AABB& box, std::vector<unsigned int>& out) const;
+
+	inline unsigned int GetUserData(int proxy) const { return m_Nodes[proxy].userData; }
+	inline const AABB& GetFatAABB(int proxy) const { return m_Nodes[proxy].box; }
+	inline unsigned int GetProxyCount() const { return m_ProxyCount; }
+	inline int GetHeight() const { return m_Root == Null ? 0 : m_Nodes[m_Root].height; }
+
+private:
+	int AllocateNode();
+	void FreeNode(int node);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	// Rotates the taller grandchild up if node is out of balance; returns the subtree's new root
+	int Balance(int node);
+	// Walks from node to the root, rebalancing and refitting boxes and heights
+	void Refit(int node);
+	void QuerySubtree(int root, const AABB& box, std::vector<unsigned int>& out) const;
+};
@@ -0,0 +1,108 @@
+#include "Animation.h"
+#include "VertexBuffer.h"
+#include "GLState.h"
+#include "Renderer.h"
+
+#include<cmath>
+
+AnimationSet::AnimationSet()
+	: m_KeyframeBuffer(nullptr), m_TrackBuffer(nullptr), m_Dirty(false)
+{
+}
+
+AnimationSet::~AnimationSet()
+{
+	delete m_TrackBuffer;
+	delete m_KeyframeBuffer;
+}
+
+unsigned int AnimationSet::AddTrack(const AnimationKeyframe* keyframes, unsigned int count, bool loop)
+{
+	ASSERT(count > 0);
+	for (unsigned int i = 1; i < count; i++)
+		ASSERT(keyframes[i - 1].time <= keyframes[i].time);
+
+	Track track;
+	track.firstKeyframe = (unsigned int)m_Keyframes.size();
+	track.keyframeCount = count;
+	track.duration = keyframes[count - 1].time;
+	track.loop = loop ? 1 : 0;
+
+	m_Keyframes.insert(m_Keyframes.end(), keyframes, keyframes + count);
+	m_Tracks.push_back(track);
+	m_Dirty = true;
+	return (unsigned int)m_Tracks.size() - 1;
+}
+
+void AnimationSet::Clear()
+{
+	m_Keyframes.clear();
+	m_Tracks.clear();
+	m_Dirty = true;
+}
+
+void AnimationSet::Evaluate(unsigned int track, float time, AnimationSample& out) const
+{
+	ASSERT(track < m_Tracks.size());
+	const Track& t = m_Tracks[track];
+	const AnimationKeyframe* keyframes = &m_Keyframes[t.firstKeyframe];
+
+	// Same steps as Animated.shader, so both land on the same keyframes
+	if (t.loop && t.duration > 0.0f)
+		time = time - t.duration * std::floor(time / t.duration);
+
+	// First keyframe after time
+	unsigned int low = 0, high = t.keyframeCount;
+	while (low < high)
+	{
+		const unsigned int middle = (low + high) / 2;
+		if (keyframes[middle].time <= time)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	const AnimationKeyframe& a = keyframes[low > 0 ? low - 1 : 0];
+	const AnimationKeyframe& b = keyframes[low < t.keyframeCount ? low : t.keyframeCount - 1];
+	float s = 0.0f;
+	if (low > 0 && low < t.keyframeCount && a.interpolation == AnimationInterpolation::Linear)
+		s = (time - a.time) / (b.time - a.time);
+
+	out.offsetX = a.offsetX + (b.offsetX - a.offsetX) * s;
+	out.offsetY = a.offsetY + (b.offsetY - a.offsetY) * s;
+	for (unsigned int i = 0; i < 4; i++)
+		out.color[i] = a.color[i] + (b.color[i] - a.color[i]) * s;
+}
+
+void AnimationSet::Bind()
+{
+	ASSERT(IsGPUPath());
+	if (m_Dirty && !m_Tracks.empty())
+	{
+		const unsigned int keyframeSize = (unsigned int)(m_Keyframes.size() * sizeof(AnimationKeyframe));
+		const unsigned int trackSize = (unsigned int)(m_Tracks.size() * sizeof(Track));
+		if (m_KeyframeBuffer)
+		{
+			m_KeyframeBuffer->SetData(m_Keyframes.data(), keyframeSize);
+			m_TrackBuffer->SetData(m_Tracks.data(), trackSize);
+		}
+		else
+		{
+			m_KeyframeBuffer = new VertexBuffer(m_Keyframes.data(), keyframeSize);
+			m_TrackBuffer = new VertexBuffer(m_Tracks.data(), trackSize);
+		}
+		m_Dirty = false;
+	}
+
+	if (!m_KeyframeBuffer)
+		return;
+
+	GLState& state = GLState::Get();
+	state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, ANIMATION_KEYFRAME_BINDING, m_KeyframeBuffer->GetRendererID());
+	state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, ANIMATION_TRACK_BINDING, m_TrackBuffer->GetRendererID());
+}
+
+bool AnimationSet::IsGPUPath() const
+{
+	return GLGetCapabilities().VertexShaderStorage;
+}
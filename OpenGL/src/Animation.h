@@ -0,0 +1,80 @@
+#pragma once
+
+#include<vector>
+
+class VertexBuffer;
+
+// Storage block bindings read by Animated.shader
+const unsigned int ANIMATION_KEYFRAME_BINDING = 4;
+const unsigned int ANIMATION_TRACK_BINDING = 5;
+
+enum class AnimationInterpolation : unsigned int
+{
+	// Blend towards the next keyframe
+	Linear = 0,
+	// Keep this keyframe's values until the next one
+	Step = 1
+};
+
+// Laid out as Animated.shader's std430 Keyframe struct, 32 bytes
+struct AnimationKeyframe
+{
+	// Seconds from the start of the track, ascending within a track
+	float time;
+	// How to get from this keyframe to the next
+	AnimationInterpolation interpolation;
+	float offsetX, offsetY;
+	float color[4];
+};
+
+struct AnimationSample
+{
+	float offsetX, offsetY;
+	float color[4];
+};
+
+// Keyframe tracks for offsets and colors, kept in two storage buffers so Animated.shader
+// can evaluate any object's track from nothing but u_Time and the track index: objects
+// that only animate cost no CPU work per frame. Evaluate() does the same on the CPU, for
+// picking and for contexts without vertex shader storage, where the results go to
+// Basic.shader as uniforms instead.
+class AnimationSet
+{
+private:
+	// Laid out as Animated.shader's std430 Track struct
+	struct Track
+	{
+		unsigned int firstKeyframe;
+		unsigned int keyframeCount;
+		// Time of the last keyframe; looping tracks wrap at this point
+		float duration;
+		unsigned int loop;
+	};
+
+	std::vector<AnimationKeyframe> m_Keyframes;
+	std::vector<Track> m_Tracks;
+	VertexBuffer* m_KeyframeBuffer;
+	VertexBuffer* m_TrackBuffer;
+	bool m_Dirty;
+
+public:
+	AnimationSet();
+	~AnimationSet();
+
+	AnimationSet(const AnimationSet&) = delete;
+	AnimationSet& operator=(const AnimationSet&) = delete;
+
+	// Copies count keyframes into a new track and returns its index. Before the first
+	// keyframe and after the last one the values hold, unless the track loops.
+	unsigned int AddTrack(const AnimationKeyframe* keyframes, unsigned int count, bool loop);
+	void Clear();
+
+	void Evaluate(unsigned int track, float time, AnimationSample& out) const;
+
+	// Uploads tracks added since the last call and binds both buffers for Animated.shader.
+	// Only with vertex shader storage.
+	void Bind();
+
+	inline unsigned int GetTrackCount() const { return (unsigned int)m_Tracks.size(); }
+	bool IsGPUPath() const;
+};
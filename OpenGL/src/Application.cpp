@@ -1,8 +1,10 @@
 #include<GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include<algorithm>
 #include<iostream>
 #include<fstream>
+#include<memory>
 #include<string>
 #include<sstream>
 #include<vector>
@@ -13,11 +15,40 @@
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
+#include "VertexArrayCache.h"
 #include "Shader.h"
-
-const unsigned int VERTEX_COUNT = 120;
-
-float x = 0.0f, y = 0.0f;
+#include "GLState.h"
+#include "RenderQueue.h"
+#include "Geometry.h"
+#include "CircleLOD.h"
+#include "Tessellator.h"
+#include "Scene.h"
+#include "Math2D.h"
+#include "SpatialGrid.h"
+#include "PickingBuffer.h"
+#include "AABBTree.h"
+#include "JobSystem.h"
+#include "CirclePhysics.h"
+#include "FixedTimestep.h"
+#include "ParticleSystem.h"
+#include "Animation.h"
+
+// Largest distance in pixels the tessellated rim may stray from the true circle
+const float MAX_PIXEL_ERROR = 0.5f;
+
+// Window pixels (500 x 500, y down) to [-1, 1] with y up, the space shapes are drawn in
+static const Mat3 s_WindowToNormalized = Mat3::TRS(-1.0f, 1.0f, 0.0f, 2.0f / 500, -2.0f / 500);
+
+static Scene s_Scene;
+// The circle moved with WASD
+static EntityHandle s_Player;
+static SpatialGrid s_Grid;
+// Bounds of every entity, tagged with its slot, for view culling
+static AABBTree s_Culling;
+// Culling proxy of every entity, indexed by slot
+static std::vector<int> s_Proxies;
+// Pixel (y up) to read back from the ID buffer on the next frame, -1 if none
+static int s_GPUPickX = -1, s_GPUPickY = -1;
 
 static float normalise_mouse_position(double pos)
 {
@@ -27,8 +58,12 @@ static float normalise_mouse_position(double pos)
 
 static void keyboard_press_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-    if (action == GLFW_PRESS || action == GLFW_REPEAT)
+    if ((action == GLFW_PRESS || action == GLFW_REPEAT) && s_Scene.IsValid(s_Player))
     {
+        unsigned int player = s_Scene.GetIndex(s_Player);
+        float& x = s_Scene.GetX()[player];
+        float& y = s_Scene.GetY()[player];
+
         if (key == GLFW_KEY_A)
             x -= 0.01f;
         else if (key == GLFW_KEY_D)
@@ -37,6 +72,10 @@ static void keyboard_press_callback(GLFWwindow* window, int key, int scancode, i
             y += 0.01f;
         else if (key == GLFW_KEY_S)
             y -= 0.01f;
+
+        const float r = s_Scene.GetRadius()[player];
+        s_Grid.Move(s_Player, x, y, r);
+        s_Culling.MoveProxy(s_Proxies[s_Player.slot], AABB{ x - r, y - r, x + r, y + r });
     }
 
     if (action == GLFW_RELEASE)
@@ -50,42 +89,19 @@ static void mouse_button_callback(GLFWwindow* window, int button, int action, in
         double xpos, ypos;
         //getting cursor position
         glfwGetCursorPos(window, &xpos, &ypos);
-        xpos = (double)((xpos / 500) * 2 - 1);
-        ypos = (double)((ypos / 500) * 2 - 1);
-        std::cout << "Cursor Position at (" << xpos << " , " << (ypos) << ")" << std::endl;
-    }
-
-}
+        Vec2 cursor = s_WindowToNormalized.TransformPoint(Vec2((float)xpos, (float)ypos));
+        std::cout << "Cursor Position at (" << cursor.x << " , " << (cursor.y) << ")" << std::endl;
 
-static std::vector<float> GetPositions(float x, float y, float radius, unsigned int vertex_count)
-{
-    float theta = ((360.0 / (float)vertex_count)*3.142)/180.0;
-    std::vector<float> positions = { x, y, (x + radius), y };
+        EntityHandle picked = s_Grid.Pick(s_Scene, cursor.x, cursor.y);
+        if (s_Scene.IsValid(picked))
+            std::cout << "Picked entity " << picked.slot << std::endl;
 
-    for (unsigned int i = 1; i <= vertex_count; i++)
-    {
-        positions.push_back(x + (radius * cos(theta * i)));
-        positions.push_back(y + (radius * sin(theta * i)));
+        s_GPUPickX = (int)xpos;
+        s_GPUPickY = 500 - 1 - (int)ypos;
     }
-    positions.push_back((x + radius));
-    positions.push_back(y);
-    return positions;
-}
-
-static std::vector<unsigned int> GetIndices(unsigned int vertex_count)
-{
-    std::vector<unsigned int> indices = {};
 
-    for (unsigned int i = 1, j = 2; i < vertex_count + 2 && j <= vertex_count + 2; i++, j++)
-    {
-        indices.push_back(0);
-        indices.push_back(i);
-        indices.push_back(j);
-    }
-    
-    return indices;
 }
- 
+
 int main(void)
 {
     GLFWwindow* window;
@@ -115,22 +131,39 @@ int main(void)
     }
 
     std::cout << "[Debug] OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
+    GLLoadCapabilities();
     
-    float x = 0.0f, y = 0.0f, radius = 0.2f;
+    float radius = 0.2f;
     
     {
-        extern float x, y;
+        const float black[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        s_Player = s_Scene.Create(0.0f, 0.0f, radius, black);
+        s_Grid.Insert(s_Player, 0.0f, 0.0f, radius);
+        s_Proxies.resize(s_Player.slot + 1, -1);
+        s_Proxies[s_Player.slot] = s_Culling.CreateProxy(AABB{ -radius, -radius, radius, radius }, s_Player.slot);
 
-        std::vector<float> positions = GetPositions(x, y, radius, VERTEX_COUNT);
+        unsigned char lod = SelectCircleLOD(GetProjectedRadius(radius, 500.0f), MAX_PIXEL_ERROR, CIRCLE_LOD_NONE);
+        const unsigned int segments = CircleLODSegments[lod];
 
-        std::vector<unsigned int> indices = GetIndices(VERTEX_COUNT);
+        std::vector<unsigned int> indices = GetIndices(segments);
 
-        VertexArray va;
-        VertexBuffer vb(&positions[0], positions.capacity() * sizeof(float));
+        // Tessellate straight into the buffer instead of staging through a vector
+        const unsigned int positionsSize = GetCircleVertexCount(segments) * 2 * sizeof(float);
+        VertexBuffer vb(positionsSize);
+        do
+        {
+            float* mapped = (float*)vb.Map(0, positionsSize);
+            ASSERT(mapped);
+            unsigned int written = GetPositions(mapped, 0.0f, 0.0f, radius, segments);
+            vb.FlushMappedRange(0, written * sizeof(float));
+        } while (!vb.Unmap());
 
         VertexBufferLayout layout;
         layout.Push<float>(2);
-        va.AddBuffer(vb, layout);
+
+        // Every mesh with this layout shares the same vertex array
+        VertexArrayCache vertexArrays;
+        VertexArray& va = vertexArrays.Get(layout);
 
         IndexBuffer ib(&indices[0], indices.size());
 
@@ -138,17 +171,49 @@ int main(void)
         shader.Bind();
         shader.SetUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
         shader.SetUniform1f("u_Offset", 0.2);
-
-        va.Unbind();
-        vb.Unbind();
-        ib.Unbind();
         shader.Unbind();
 
-        float r,g,b;
-        r = g = b = 0.0f;
-        float increment = 0.05f;
-
-        float theta = 0.1f;
+        // The player fades in red, then green, then blue, and starts over from black;
+        // evaluated on the GPU from u_Time where the vertex stage can read storage buffers
+        AnimationSet animations;
+        const AnimationKeyframe playerKeyframes[] = {
+            { 0.0f, AnimationInterpolation::Linear, 0.0f, 0.0f, { 0.0f, 0.0f, 0.0f, 1.0f } },
+            { 1.0f, AnimationInterpolation::Linear, 0.0f, 0.0f, { 1.0f, 0.0f, 0.0f, 1.0f } },
+            { 2.0f, AnimationInterpolation::Linear, 0.0f, 0.0f, { 1.0f, 1.0f, 0.0f, 1.0f } },
+            { 3.0f, AnimationInterpolation::Linear, 0.0f, 0.0f, { 1.0f, 1.0f, 1.0f, 1.0f } },
+        };
+        const unsigned int playerTrack = animations.AddTrack(playerKeyframes, 4, true);
+        std::unique_ptr<Shader> animatedShader;
+        if (animations.IsGPUPath())
+            animatedShader.reset(new Shader("res/Shaders/Animated.shader"));
+        AnimationSample playerSample;
+
+        RenderQueue queue;
+
+        // IDs are entity slots + 1, so 0 is left for the background
+        PickingBuffer picking(500, 500);
+        Shader pickShader("res/Shaders/PickID.shader");
+        PickResult pickResult;
+
+        // Only what overlaps the view is drawn; shapes are drawn in [-1, 1] for now
+        const AABB view = { -1.0f, -1.0f, 1.0f, 1.0f };
+        std::vector<unsigned int> visible;
+        std::vector<CircleInstance> instances;
+
+        // Simulation runs on a fixed 60 Hz step, however fast frames come
+        JobSystem jobs;
+        CirclePhysics physics;
+        FixedTimestep timestep(1.0 / 60.0);
+
+        // Sparks trailing the player, drawn as one instanced batch
+        ParticleSystem particles(20000);
+        particles.GetEmitter().rate = 2000.0f;
+        const unsigned int particleBytes = particles.GetCapacity() * sizeof(CircleInstance);
+        VertexBuffer particleInstances(particleBytes);
+        CircleLODMeshes circleMeshes;
+        circleMeshes.SetInstanceBuffer(particleInstances);
+        Shader circleShader("res/Shaders/Circle.shader");
+        const unsigned char particleLOD = SelectCircleLOD(GetProjectedRadius(particles.GetEmitter().startRadius, 500.0f), MAX_PIXEL_ERROR, CIRCLE_LOD_NONE);
 
         /* Loop until the user closes the window */
         while (!glfwWindowShouldClose(window))
@@ -156,39 +221,129 @@ int main(void)
             /* Render here */
             glClear(GL_COLOR_BUFFER_BIT);
 
-            shader.Bind();
-            shader.SetUniform4f("u_Color", r, g, b, 1.0f);
-            shader.SetUniform2f("u_Offset", x, y);
+            const unsigned int steps = timestep.Advance(glfwGetTime());
+            for (unsigned int step = 0; step < steps; step++)
+                physics.Step(jobs, s_Scene, timestep.GetStep());
+            if (steps > 0)
+            {
+                s_Grid.Update(s_Scene);
+
+                // Physics moves every entity, so every proxy has to follow
+                const float* x = s_Scene.GetX();
+                const float* y = s_Scene.GetY();
+                const float* r = s_Scene.GetRadius();
+                for (unsigned int i = 0; i < s_Scene.GetCount(); i++)
+                    s_Culling.MoveProxy(s_Proxies[s_Scene.GetHandle(i).slot], AABB{ x[i] - r[i], y[i] - r[i], x[i] + r[i], y[i] + r[i] });
+            }
 
-            va.Bind();
-            ib.Bind();
+            ParticleEmitter& emitter = particles.GetEmitter();
+            const unsigned int emitterEntity = s_Scene.GetIndex(s_Player);
+            emitter.x = s_Scene.GetX()[emitterEntity];
+            emitter.y = s_Scene.GetY()[emitterEntity];
+            for (unsigned int step = 0; step < steps; step++)
+                particles.Update(jobs, timestep.GetStep());
+
+            visible.clear();
+            s_Culling.Query(view, visible);
+            // Drop slots whose entity is gone, so visible[i] stays the slot of instances[i]
+            visible.erase(std::remove_if(visible.begin(), visible.end(),
+                [](unsigned int slot) { return s_Scene.GetSlotIndex(slot) == Scene::InvalidIndex; }), visible.end());
+            // The tree returns them in traversal order; draw in scene order instead, which is
+            // what SpatialGrid::Pick takes as topmost. The queue's stable sort keeps this
+            // order among draws that share a shader.
+            std::sort(visible.begin(), visible.end(),
+                [](unsigned int a, unsigned int b) { return s_Scene.GetSlotIndex(a) < s_Scene.GetSlotIndex(b); });
+            instances.resize(visible.size());
+            instances.resize(s_Scene.WriteInstances(instances.data(), visible.data(), (unsigned int)visible.size()));
+
+            const float time = (float)glfwGetTime();
+            if (animatedShader)
+            {
+                animatedShader->Bind();
+                animatedShader->SetUniform1f("u_Time", time);
+                animations.Bind();
+            }
 
-            glDrawElements(GL_TRIANGLE_FAN, indices.size(), GL_UNSIGNED_INT, 0);
-            va.Unbind();
+            queue.Begin();
 
-            if (r > 1.0f)
-                g += increment;
-            if (g > 1.0f)
-                b += increment;
-            if (b > 1.0f)
+            for (unsigned int i = 0; i < instances.size(); i++)
             {
-                r = 0.0f;
-                b = 0.0f;
-                g = 0.0f;
+                const CircleInstance& instance = instances[i];
+                DrawCall circle;
+                circle.shader = &shader;
+                circle.vertexArray = &va;
+                circle.vertexBuffer = &vb;
+                circle.indexBuffer = &ib;
+                circle.mode = GL_TRIANGLE_FAN;
+                circle.color[0] = instance.color[0];
+                circle.color[1] = instance.color[1];
+                circle.color[2] = instance.color[2];
+                circle.offset[0] = instance.x;
+                circle.offset[1] = instance.y;
+                if (visible[i] == s_Player.slot)
+                {
+                    if (animatedShader)
+                    {
+                        circle.shader = animatedShader.get();
+                        circle.animationTrack = (int)playerTrack;
+                        circle.color[0] = circle.color[1] = circle.color[2] = 1.0f;
+                    }
+                    else
+                    {
+                        animations.Evaluate(playerTrack, time, playerSample);
+                        circle.color[0] = playerSample.color[0];
+                        circle.color[1] = playerSample.color[1];
+                        circle.color[2] = playerSample.color[2];
+                        circle.offset[0] += playerSample.offsetX;
+                        circle.offset[1] += playerSample.offsetY;
+                    }
+                }
+                queue.Submit(circle);
             }
-            else
-                r += increment;
 
-            if (theta > 6.28f)
-                theta = 0.1f;
-            else
-                theta += 0.1f;
+            queue.Flush();
 
-            // std::cout << r << "," << g << "," << b<<std::endl;
-
-            /*x = cos(theta) * 0.75f;
-            y = sin(theta) * 0.75f;*/
+            unsigned int particleCount = 0;
+            do
+            {
+                CircleInstance* mapped = (CircleInstance*)particleInstances.Map(0, particleBytes);
+                ASSERT(mapped);
+                particleCount = particles.WriteInstances(jobs, mapped, particles.GetCapacity());
+                particleInstances.FlushMappedRange(0, particleCount * sizeof(CircleInstance));
+            } while (!particleInstances.Unmap());
+            // Sparks fade out through their alpha
+            GLState& blendState = GLState::Get();
+            blendState.SetBlend(true);
+            blendState.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            circleShader.Bind();
+            circleMeshes.Draw(particleLOD, particleInstances, 0, particleCount);
+            blendState.SetBlend(false);
+
+            unsigned int player = s_Scene.GetIndex(s_Player);
+
+            if (s_GPUPickX >= 0)
+            {
+                animations.Evaluate(playerTrack, time, playerSample);
+                picking.Begin();
+                pickShader.Bind();
+                pickShader.SetUniform2f("u_Offset", s_Scene.GetX()[player] + playerSample.offsetX, s_Scene.GetY()[player] + playerSample.offsetY);
+                pickShader.SetUniform1ui("u_ID", s_Player.slot + 1);
+                va.Bind();
+                va.BindVertexBuffer(vb);
+                ib.Bind();
+                glDrawElements(GL_TRIANGLE_FAN, ib.GetCount(), GL_UNSIGNED_INT, nullptr);
+                picking.End(500, 500);
+
+                picking.RequestRead(s_GPUPickX, s_GPUPickY, 1, 1);
+                s_GPUPickX = s_GPUPickY = -1;
+            }
 
+            // Results arrive a frame or two after the request
+            while (picking.Poll(pickResult))
+            {
+                for (unsigned int id : pickResult.ids)
+                    std::cout << "GPU picked entity " << id - 1 << std::endl;
+            }
 
             Sleep(50);
 
@@ -198,6 +353,14 @@ int main(void)
             /* Poll for and process events */
             glfwPollEvents();
         }
+
+        GLState& state = GLState::Get();
+        std::cout << "[Debug] State changes issued: " << state.GetIssuedCount()
+            << ", eliminated: " << state.GetEliminatedCount() << std::endl;
+
+        const RenderQueueStats& stats = queue.GetStats();
+        std::cout << "[Debug] Render queue: " << stats.Draws << " draws, state changes "
+            << stats.StateChangesUnsorted << " unsorted / " << stats.StateChangesSorted << " sorted" << std::endl;
     }
     glfwTerminate();
     return 0;
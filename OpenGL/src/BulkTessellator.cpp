@@ -0,0 +1,119 @@
+#include "BulkTessellator.h"
+#include "JobSystem.h"
+
+// Several chunks per thread so uneven shapes still balance, but large enough that
+// claiming a chunk stays cheap next to the work in it
+static unsigned int GetChunkSize(const JobSystem& jobs, unsigned int count)
+{
+	unsigned int chunkSize = count / (jobs.GetThreadCount() * 8);
+	return chunkSize < 256 ? 256 : chunkSize;
+}
+
+void ComputeBulkLayout(JobSystem& jobs, const BulkShape* shapes, unsigned int count, Topology topology, BulkLayout& layout)
+{
+	const bool restart = topology != Topology::TriangleList;
+	const unsigned int chunkSize = GetChunkSize(jobs, count);
+	const unsigned int chunks = (count + chunkSize - 1) / chunkSize;
+
+	layout.firstVertex.resize(count);
+	layout.firstIndex.resize(count);
+	std::vector<unsigned int> chunkVertices(chunks), chunkIndices(chunks);
+
+	// Scan each chunk locally and keep its totals
+	jobs.ParallelFor(count, chunkSize, [&](unsigned int begin, unsigned int end)
+	{
+		unsigned int vertices = 0, indices = 0;
+		for (unsigned int i = begin; i < end; i++)
+		{
+			layout.firstVertex[i] = vertices;
+			layout.firstIndex[i] = indices;
+			vertices += GetCircleVertexCount(shapes[i].segments);
+			indices += GetCircleIndexCount(topology, shapes[i].segments) + (restart && i > 0 ? 1 : 0);
+		}
+		chunkVertices[begin / chunkSize] = vertices;
+		chunkIndices[begin / chunkSize] = indices;
+	});
+
+	// Scan the chunk totals; there are only a few per thread
+	unsigned int vertices = 0, indices = 0;
+	for (unsigned int c = 0; c < chunks; c++)
+	{
+		unsigned int chunkVertexCount = chunkVertices[c], chunkIndexCount = chunkIndices[c];
+		chunkVertices[c] = vertices;
+		chunkIndices[c] = indices;
+		vertices += chunkVertexCount;
+		indices += chunkIndexCount;
+	}
+	layout.vertexCount = vertices;
+	layout.indexCount = indices;
+
+	// Offset every chunk by the totals before it
+	jobs.ParallelFor(count, chunkSize, [&](unsigned int begin, unsigned int end)
+	{
+		unsigned int vertexBase = chunkVertices[begin / chunkSize], indexBase = chunkIndices[begin / chunkSize];
+		if (vertexBase == 0 && indexBase == 0)
+			return;
+		for (unsigned int i = begin; i < end; i++)
+		{
+			layout.firstVertex[i] += vertexBase;
+			layout.firstIndex[i] += indexBase;
+		}
+	});
+}
+
+void TessellateShapes(JobSystem& jobs, const BulkShape* shapes, unsigned int count, Topology topology, const BulkLayout& layout, float* vertices, unsigned int* indices)
+{
+	const bool restart = topology != Topology::TriangleList;
+
+	jobs.ParallelFor(count, GetChunkSize(jobs, count), [&](unsigned int begin, unsigned int end)
+	{
+		// Neighbouring shapes usually share a segment count; reuse the table rather
+		// than taking the cache lock, or rebuilding the arc, for every shape
+		const ArcTable* table = nullptr;
+		ArcTable arcTable;
+		const BulkShape* tableShape = nullptr;
+
+		for (unsigned int i = begin; i < end; i++)
+		{
+			const BulkShape& shape = shapes[i];
+			const bool isArc = shape.kind == ShapeKind::Arc;
+
+			if (!tableShape || tableShape->segments != shape.segments || (tableShape->kind == ShapeKind::Arc) != isArc ||
+				(isArc && (tableShape->startAngle != shape.startAngle || tableShape->endAngle != shape.endAngle)))
+			{
+				if (isArc)
+				{
+					BuildArcTable(arcTable, shape.segments, shape.startAngle, shape.endAngle);
+					table = &arcTable;
+				}
+				else
+				{
+					table = &GetUnitCircleTable(shape.segments);
+				}
+				tableShape = &shape;
+			}
+
+			const unsigned int baseVertex = layout.firstVertex[i];
+			float* out = vertices + 2 * baseVertex;
+			out[0] = shape.x;
+			out[1] = shape.y;
+			TessellateTable(out + 2, *table, shape.x, shape.y, shape.rx, shape.kind == ShapeKind::Ellipse ? shape.ry : shape.rx);
+
+			unsigned int* outIndices = indices + layout.firstIndex[i];
+			if (restart && i > 0)
+				*outIndices++ = PRIMITIVE_RESTART_INDEX;
+			GenerateCircleIndices(outIndices, topology, shape.segments, baseVertex);
+		}
+	});
+}
+
+void TessellateShapes(JobSystem& jobs, const BulkShape* shapes, unsigned int count, Topology topology, BulkMesh& mesh)
+{
+	mesh.topology = topology;
+	ComputeBulkLayout(jobs, shapes, count, topology, mesh.layout);
+
+	mesh.vertices.resize(mesh.layout.vertexCount * 2);
+	mesh.indices.resize(mesh.layout.indexCount);
+	if (count > 0)
+		TessellateShapes(jobs, shapes, count, topology, mesh.layout, mesh.vertices.data(), mesh.indices.data());
+}
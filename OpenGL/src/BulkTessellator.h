@@ -0,0 +1,51 @@
+#pragma once
+
+#include<vector>
+
+#include "IndexGenerator.h"
+#include "Tessellator.h"
+
+class JobSystem;
+
+// One shape of a bulk batch. Regular polygons are circles with segments = sides.
+struct BulkShape
+{
+	ShapeKind kind = ShapeKind::Circle;
+	unsigned int segments = 32;
+	float x = 0.0f, y = 0.0f;
+	// Circles and arcs only use rx
+	float rx = 1.0f, ry = 1.0f;
+	// Arcs only, radians counter-clockwise from +x
+	float startAngle = 0.0f, endAngle = 0.0f;
+};
+
+// Where each shape lands in the batch: exclusive prefix sums of the per-shape
+// vertex and index counts, plus the totals.
+struct BulkLayout
+{
+	std::vector<unsigned int> firstVertex;
+	std::vector<unsigned int> firstIndex;
+	unsigned int vertexCount = 0;
+	unsigned int indexCount = 0;
+};
+
+struct BulkMesh
+{
+	BulkLayout layout;
+	// Interleaved x, y
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	Topology topology = Topology::TriangleFan;
+};
+
+// Sizes every shape and scans the counts in parallel. Fans and strips get a
+// PRIMITIVE_RESTART_INDEX in front of every shape but the first, as in IndexBatch.
+void ComputeBulkLayout(JobSystem& jobs, const BulkShape* shapes, unsigned int count, Topology topology, BulkLayout& layout);
+
+// Fills vertices (2 * layout.vertexCount floats) and indices (layout.indexCount) in
+// parallel. Each shape writes only its own range, so the outputs can be mapped buffers.
+// Arcs drawn as strips cover the chord-closed segment rather than the sector.
+void TessellateShapes(JobSystem& jobs, const BulkShape* shapes, unsigned int count, Topology topology, const BulkLayout& layout, float* vertices, unsigned int* indices);
+
+// Both passes into mesh; its storage is reused across calls
+void TessellateShapes(JobSystem& jobs, const BulkShape* shapes, unsigned int count, Topology topology, BulkMesh& mesh);
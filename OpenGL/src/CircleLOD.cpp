@@ -0,0 +1,107 @@
+#include "CircleLOD.h"
+#include "Geometry.h"
+#include "Renderer.h"
+#include "GLState.h"
+
+#include<cmath>
+#include<cstdint>
+#include<vector>
+
+static const float PI = 3.14159265f;
+
+unsigned int GetCircleSegmentsForError(float radiusPixels, float maxErrorPixels)
+{
+	// A chord spanning angle a misses the arc by r * (1 - cos(a / 2))
+	if (radiusPixels <= maxErrorPixels)
+		return 3;
+	float halfAngle = std::acos(1.0f - maxErrorPixels / radiusPixels);
+	return (unsigned int)std::ceil(PI / halfAngle);
+}
+
+static unsigned char LevelForSegments(unsigned int segments)
+{
+	for (unsigned char level = 0; level < CIRCLE_LOD_COUNT; level++)
+	{
+		if (CircleLODSegments[level] >= segments)
+			return level;
+	}
+	return CIRCLE_LOD_COUNT - 1;
+}
+
+unsigned char SelectCircleLOD(float radiusPixels, float maxErrorPixels, unsigned char currentLevel, float hysteresis)
+{
+	unsigned char ideal = LevelForSegments(GetCircleSegmentsForError(radiusPixels, maxErrorPixels));
+	if (currentLevel == CIRCLE_LOD_NONE || ideal >= currentLevel)
+		return ideal;
+
+	// Only coarsen once the circle would still be fine if it grew back by the hysteresis margin
+	unsigned char coarser = LevelForSegments(GetCircleSegmentsForError(radiusPixels * (1.0f + hysteresis), maxErrorPixels));
+	return coarser < currentLevel ? coarser : currentLevel;
+}
+
+CircleLODMeshes::CircleLODMeshes()
+	: m_InstanceStride(sizeof(CircleInstance))
+{
+	std::vector<float> positions;
+	std::vector<unsigned int> indices;
+
+	for (unsigned int level = 0; level < CIRCLE_LOD_COUNT; level++)
+	{
+		std::vector<float> levelPositions = GetPositions(0.0f, 0.0f, 1.0f, CircleLODSegments[level]);
+		std::vector<unsigned int> levelIndices = GetIndices(CircleLODSegments[level]);
+
+		m_BaseVertex[level] = (int)(positions.size() / 2);
+		m_FirstIndex[level] = (unsigned int)indices.size();
+		m_IndexCount[level] = (unsigned int)levelIndices.size();
+
+		positions.insert(positions.end(), levelPositions.begin(), levelPositions.end());
+		indices.insert(indices.end(), levelIndices.begin(), levelIndices.end());
+	}
+
+	m_Vertices = new VertexBuffer(positions.data(), (unsigned int)(positions.size() * sizeof(float)));
+	m_Indices = new IndexBuffer(indices.data(), (unsigned int)indices.size());
+
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	m_VertexArray.AddBuffer(*m_Vertices, layout);
+	m_VertexArray.SetIndexBuffer(*m_Indices);
+}
+
+CircleLODMeshes::~CircleLODMeshes()
+{
+	delete m_Indices;
+	delete m_Vertices;
+}
+
+void CircleLODMeshes::SetInstanceBuffer(const VertexBuffer& instances)
+{
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	layout.Push<float>(4);
+	SetInstanceBuffer(instances, layout);
+}
+
+void CircleLODMeshes::SetInstanceBuffer(const VertexBuffer& instances, const VertexBufferLayout& layout)
+{
+	m_InstanceStride = layout.GetStride();
+	m_VertexArray.AddInstanceBuffer(instances, layout, 1);
+}
+
+void CircleLODMeshes::Draw(unsigned char level, const VertexBuffer& instances, unsigned int firstInstance, unsigned int instanceCount)
+{
+	if (instanceCount == 0)
+		return;
+
+	m_VertexArray.Bind();
+	m_VertexArray.BindInstanceBuffer(instances, firstInstance * m_InstanceStride);
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLE_FAN, m_IndexCount[level], GL_UNSIGNED_INT,
+		(void*)(uintptr_t)(m_FirstIndex[level] * sizeof(unsigned int)), instanceCount, m_BaseVertex[level]);
+}
+
+void CircleLODMeshes::DrawIndirect(const VertexBuffer& instances, unsigned int indirectBuffer, unsigned int offset)
+{
+	m_VertexArray.Bind();
+	m_VertexArray.BindInstanceBuffer(instances, 0);
+	GLState::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+	glDrawElementsIndirect(GL_TRIANGLE_FAN, GL_UNSIGNED_INT, (void*)(uintptr_t)offset);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+// Quantized segment counts shared by every circle; level 0 is the coarsest
+const unsigned int CIRCLE_LOD_COUNT = 6;
+const unsigned int CircleLODSegments[CIRCLE_LOD_COUNT] = { 8, 16, 32, 64, 128, 256 };
+const unsigned char CIRCLE_LOD_NONE = 0xFF;
+
+// Fewest segments that keep the polygon within maxErrorPixels of the true circle
+unsigned int GetCircleSegmentsForError(float radiusPixels, float maxErrorPixels);
+
+// Picks a level for a circle of the given on-screen radius. Refining happens as soon as
+// the error is exceeded; coarsening waits until the radius has shrunk a further
+// hysteresis fraction, so a circle hovering at a threshold does not flicker.
+// Pass CIRCLE_LOD_NONE as currentLevel the first time.
+unsigned char SelectCircleLOD(float radiusPixels, float maxErrorPixels, unsigned char currentLevel, float hysteresis = 0.15f);
+
+// Radius in pixels of an NDC-space radius on a viewport viewportHeight pixels tall
+inline float GetProjectedRadius(float radius, float viewportHeight) { return radius * viewportHeight * 0.5f; }
+
+// Per-instance data read by Circle.shader
+struct CircleInstance
+{
+	float x, y, radius;
+	float color[4];
+};
+
+// Unit circles for every level in one vertex and index buffer, drawn instanced with Circle.shader
+class CircleLODMeshes
+{
+private:
+	VertexBuffer* m_Vertices;
+	IndexBuffer* m_Indices;
+	VertexArray m_VertexArray;
+	unsigned int m_FirstIndex[CIRCLE_LOD_COUNT];
+	unsigned int m_IndexCount[CIRCLE_LOD_COUNT];
+	int m_BaseVertex[CIRCLE_LOD_COUNT];
+	unsigned int m_InstanceStride;
+
+public:
+	CircleLODMeshes();
+	~CircleLODMeshes();
+
+	CircleLODMeshes(const CircleLODMeshes&) = delete;
+	CircleLODMeshes& operator=(const CircleLODMeshes&) = delete;
+
+	// CircleInstance records, at attribute locations 1 (x, y, radius) and 2 (color)
+	void SetInstanceBuffer(const VertexBuffer& instances);
+	// Any other per-instance record, its attributes from location 1 on, for a shader of its own
+	void SetInstanceBuffer(const VertexBuffer& instances, const VertexBufferLayout& layout);
+
+	// Draws instanceCount instances starting at firstInstance in the instance buffer. The shader must be bound.
+	void Draw(unsigned char level, const VertexBuffer& instances, unsigned int firstInstance, unsigned int instanceCount);
+	// Same, with the level's index range and the instance count read from a
+	// DrawElementsIndirectCommand at offset in indirectBuffer, e.g. one written by a compute pass
+	void DrawIndirect(const VertexBuffer& instances, unsigned int indirectBuffer, unsigned int offset);
+
+	inline const VertexArray& GetVertexArray() const { return m_VertexArray; }
+	inline const IndexBuffer& GetIndexBuffer() const { return *m_Indices; }
+	inline unsigned int GetFirstIndex(unsigned char level) const { return m_FirstIndex[level]; }
+	inline unsigned int GetIndexCount(unsigned char level) const { return m_IndexCount[level]; }
+	inline int GetBaseVertex(unsigned char level) const { return m_BaseVertex[level]; }
+};
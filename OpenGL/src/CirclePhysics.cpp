@@ -0,0 +1,420 @@
+#include "CirclePhysics.h"
+#include "JobSystem.h"
+#include "Scene.h"
+#include "SimdFloats.h"
+
+#include<algorithm>
+#include<chrono>
+#include<cmath>
+#include<cstring>
+#include<limits>
+
+// Entities per job for the per-entity and per-contact loops
+const unsigned int PHYSICS_CHUNK_SIZE = 4096;
+// Rows of the sweep per job; contacts are collected per row chunk and joined in order
+const unsigned int SWEEP_CHUNK_SIZE = 1024;
+// Fraction of the remaining overlap removed by the position correction
+const float POSITION_CORRECTION = 0.8f;
+// MaskBits() of a register with every lane set
+const unsigned int ALL_LANES = (1u << WIDTH) - 1;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static float MillisecondsSince(Clock::time_point start)
+{
+	return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+
+// Maps a float to an unsigned int with the same ordering
+static inline uint32_t SortableBits(float v)
+{
+	uint32_t bits;
+	memcpy(&bits, &v, sizeof(bits));
+	return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+// Linear on nearly sorted input. Gives up, leaving the range permuted, once more than
+// maxMoves elements have been shifted.
+template<typename T>
+static bool InsertionSort(T* values, unsigned int count, unsigned int maxMoves)
+{
+	unsigned int moves = 0;
+	for (unsigned int i = 1; i < count; i++)
+	{
+		if (!(values[i] < values[i - 1]))
+			continue;
+
+		const T value = values[i];
+		unsigned int j = i;
+		for (; j > 0 && value < values[j - 1]; j--)
+			values[j] = values[j - 1];
+		values[j] = value;
+
+		moves += i - j;
+		if (moves > maxMoves)
+			return false;
+	}
+	return true;
+}
+
+CirclePhysics::CirclePhysics()
+	: m_MaxRadius(0.0f), m_BandHeight(1.0f), m_Bounds{ 0.0f, 0.0f, 0.0f, 0.0f }, m_HasBounds(false),
+	m_Restitution(0.5f), m_Iterations(4)
+{
+}
+
+void CirclePhysics::SetBounds(const AABB& bounds)
+{
+	m_Bounds = bounds;
+	m_HasBounds = true;
+}
+
+void CirclePhysics::ClearBounds()
+{
+	m_HasBounds = false;
+}
+
+void CirclePhysics::Step(JobSystem& jobs, Scene& scene, float dt)
+{
+	Clock::time_point start = Clock::now();
+	Integrate(jobs, scene, dt);
+	m_Stats.IntegrateMs = MillisecondsSince(start);
+
+	start = Clock::now();
+	Sort(jobs, scene);
+	m_Stats.SortMs = MillisecondsSince(start);
+
+	start = Clock::now();
+	Sweep(jobs);
+	m_Stats.SweepMs = MillisecondsSince(start);
+
+	start = Clock::now();
+	Solve(jobs, scene);
+	m_Stats.SolveMs = MillisecondsSince(start);
+
+	m_Stats.Contacts = (unsigned int)m_Contacts.size();
+}
+
+void CirclePhysics::Integrate(JobSystem& jobs, Scene& scene, float dt)
+{
+	float* x = scene.GetX();
+	float* y = scene.GetY();
+	float* velocityX = scene.GetVelocityX();
+	float* velocityY = scene.GetVelocityY();
+	const float* radius = scene.GetRadius();
+
+	jobs.ParallelFor(scene.GetCount(), PHYSICS_CHUNK_SIZE, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+		{
+			x[i] += velocityX[i] * dt;
+			y[i] += velocityY[i] * dt;
+		}
+
+		if (!m_HasBounds)
+			return;
+
+		for (unsigned int i = begin; i < end; i++)
+		{
+			const float r = radius[i];
+			if (x[i] - r < m_Bounds.minX) { x[i] = m_Bounds.minX + r; velocityX[i] = std::abs(velocityX[i]) * m_Restitution; }
+			if (x[i] + r > m_Bounds.maxX) { x[i] = m_Bounds.maxX - r; velocityX[i] = -std::abs(velocityX[i]) * m_Restitution; }
+			if (y[i] - r < m_Bounds.minY) { y[i] = m_Bounds.minY + r; velocityY[i] = std::abs(velocityY[i]) * m_Restitution; }
+			if (y[i] + r > m_Bounds.maxY) { y[i] = m_Bounds.maxY - r; velocityY[i] = -std::abs(velocityY[i]) * m_Restitution; }
+		}
+	});
+}
+
+void CirclePhysics::Sort(JobSystem& jobs, const Scene& scene)
+{
+	const unsigned int count = scene.GetCount();
+	const float* x = scene.GetX();
+	const float* y = scene.GetY();
+	const float* radius = scene.GetRadius();
+
+	// Overlapping circles are at most two largest radii apart vertically, so bands that
+	// tall only need pairing with themselves and the band above
+	const unsigned int chunks = (count + PHYSICS_CHUNK_SIZE - 1) / PHYSICS_CHUNK_SIZE;
+	std::vector<float> chunkMaxRadius(chunks, 0.0f);
+	jobs.ParallelFor(count, PHYSICS_CHUNK_SIZE, [&](unsigned int begin, unsigned int end)
+	{
+		float maxRadius = 0.0f;
+		for (unsigned int i = begin; i < end; i++)
+			maxRadius = radius[i] > maxRadius ? radius[i] : maxRadius;
+		chunkMaxRadius[begin / PHYSICS_CHUNK_SIZE] = maxRadius;
+	});
+	m_MaxRadius = 0.0f;
+	for (float maxRadius : chunkMaxRadius)
+		m_MaxRadius = maxRadius > m_MaxRadius ? maxRadius : m_MaxRadius;
+	m_BandHeight = m_MaxRadius > 0.0f ? 2.0f * m_MaxRadius : 1.0f;
+
+	// Circles move little between steps, so listing them in last step's order leaves the
+	// sort almost nothing to do. Any permutation of [0, count) is correct, just slower.
+	const float inverseBandHeight = 1.0f / m_BandHeight;
+	const bool reuseOrder = m_Keys.size() == count;
+	m_Keys.resize(count);
+	m_Scratch.resize(count);
+	jobs.ParallelFor(count, PHYSICS_CHUNK_SIZE, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int k = begin; k < end; k++)
+		{
+			const unsigned int i = reuseOrder ? m_Keys[k].index : k;
+			const uint32_t band = (uint32_t)(int)std::floor(y[i] * inverseBandHeight) ^ 0x80000000u;
+			m_Keys[k].key = (uint64_t)band << 32 | SortableBits(x[i] - radius[i]);
+			m_Keys[k].index = i;
+		}
+	});
+
+	// Sort a run per thread, then merge pairs of runs until one is left
+	const unsigned int threads = jobs.GetThreadCount();
+	unsigned int runSize = (count + threads - 1) / threads;
+	runSize = runSize < PHYSICS_CHUNK_SIZE ? PHYSICS_CHUNK_SIZE : runSize;
+	jobs.ParallelFor(count, runSize, [&](unsigned int begin, unsigned int end)
+	{
+		if (!reuseOrder || !InsertionSort(&m_Keys[begin], end - begin, 8 * (end - begin)))
+			std::sort(m_Keys.begin() + begin, m_Keys.begin() + end);
+	});
+
+	for (unsigned int width = runSize; width < count; width *= 2)
+	{
+		const unsigned int pairs = (count + 2 * width - 1) / (2 * width);
+		jobs.ParallelFor(pairs, 1, [&](unsigned int first, unsigned int last)
+		{
+			for (unsigned int pair = first; pair < last; pair++)
+			{
+				const unsigned int begin = pair * 2 * width;
+				const unsigned int middle = std::min(begin + width, count);
+				const unsigned int end = std::min(begin + 2 * width, count);
+				std::merge(m_Keys.begin() + begin, m_Keys.begin() + middle, m_Keys.begin() + middle, m_Keys.begin() + end,
+					m_Scratch.begin() + begin);
+			}
+		});
+		m_Keys.swap(m_Scratch);
+	}
+
+	// Split the sorted keys into bands, leaving room for each band's sentinels
+	m_Bands.clear();
+	for (unsigned int k = 0; k < count; k++)
+	{
+		const int band = (int)((uint32_t)(m_Keys[k].key >> 32) ^ 0x80000000u);
+		if (m_Bands.empty() || m_Bands.back().y != band)
+			m_Bands.push_back(Band{ band, k + (unsigned int)m_Bands.size() * WIDTH, 0 });
+		m_Bands.back().count++;
+	}
+
+	// Gather into sorted order so the sweep reads every array front to back
+	const unsigned int rows = count + (unsigned int)m_Bands.size() * WIDTH;
+	m_SortedMinX.resize(rows);
+	m_SortedX.resize(rows);
+	m_SortedY.resize(rows);
+	m_SortedRadius.resize(rows);
+	m_SortedIndex.resize(rows);
+	m_SortedBand.resize(rows);
+	jobs.ParallelFor((unsigned int)m_Bands.size(), 0, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int b = begin; b < end; b++)
+		{
+			const Band& band = m_Bands[b];
+			const unsigned int firstKey = band.first - b * WIDTH;
+			for (unsigned int k = 0; k < band.count; k++)
+			{
+				const unsigned int i = m_Keys[firstKey + k].index;
+				const unsigned int row = band.first + k;
+				m_SortedIndex[row] = i;
+				m_SortedBand[row] = b;
+				m_SortedMinX[row] = x[i] - radius[i];
+				m_SortedX[row] = x[i];
+				m_SortedY[row] = y[i];
+				m_SortedRadius[row] = radius[i];
+			}
+
+			// A sentinel register ends every sweep of the band without a bounds check
+			for (unsigned int row = band.first + band.count; row < band.first + band.count + WIDTH; row++)
+			{
+				m_SortedIndex[row] = 0;
+				m_SortedBand[row] = ~0u;
+				m_SortedMinX[row] = std::numeric_limits<float>::infinity();
+				m_SortedX[row] = m_SortedY[row] = m_SortedRadius[row] = 0.0f;
+			}
+		}
+	});
+}
+
+void CirclePhysics::SweepRow(unsigned int row, unsigned int first, std::vector<CircleContact>& contacts) const
+{
+	const float xi = m_SortedX[row], yi = m_SortedY[row], ri = m_SortedRadius[row];
+	const Floats maxX = Set(xi + ri), x = Set(xi), y = Set(yi), r = Set(ri);
+
+	// Rows are sorted by left edge, so once a lane is out of range so is the rest of
+	// the band, and a register that isn't entirely in range is the last one
+	unsigned int range = ALL_LANES;
+	for (unsigned int j = first; range == ALL_LANES; j += WIDTH)
+	{
+		const Mask inRange = LessEqual(Load(&m_SortedMinX[j]), maxX);
+		range = MaskBits(inRange);
+		if (range == 0)
+			break;
+
+		const Floats dx = Sub(Load(&m_SortedX[j]), x);
+		const Floats dy = Sub(Load(&m_SortedY[j]), y);
+		const Floats reach = Add(Load(&m_SortedRadius[j]), r);
+		const unsigned int hits = MaskBits(And(inRange, Less(Add(Mul(dx, dx), Mul(dy, dy)), Mul(reach, reach))));
+
+		for (unsigned int lane = 0; hits != 0 && lane < WIDTH; lane++)
+		{
+			if (!(hits & (1u << lane)))
+				continue;
+
+			const unsigned int k = j + lane;
+			const float cx = m_SortedX[k] - xi, cy = m_SortedY[k] - yi;
+			const float distance = std::sqrt(cx * cx + cy * cy);
+
+			CircleContact contact;
+			contact.a = m_SortedIndex[row];
+			contact.b = m_SortedIndex[k];
+			contact.normalX = distance > 0.0f ? cx / distance : 1.0f;
+			contact.normalY = distance > 0.0f ? cy / distance : 0.0f;
+			contact.depth = ri + m_SortedRadius[k] - distance;
+			contacts.push_back(contact);
+		}
+	}
+}
+
+void CirclePhysics::Sweep(JobSystem& jobs)
+{
+	const unsigned int rows = (unsigned int)m_SortedIndex.size();
+	const unsigned int chunks = (rows + SWEEP_CHUNK_SIZE - 1) / SWEEP_CHUNK_SIZE;
+	m_ChunkContacts.resize(chunks);
+
+	jobs.ParallelFor(rows, SWEEP_CHUNK_SIZE, [&](unsigned int begin, unsigned int end)
+	{
+		std::vector<CircleContact>& contacts = m_ChunkContacts[begin / SWEEP_CHUNK_SIZE];
+		contacts.clear();
+
+		// First candidate in the band above; rows come in order of left edge, so it only moves right
+		unsigned int cursorBand = ~0u, cursor = 0;
+
+		for (unsigned int row = begin; row < end; row++)
+		{
+			const unsigned int b = m_SortedBand[row];
+			if (b == ~0u)
+				continue;
+
+			// Later circles in the same band
+			SweepRow(row, row + 1, contacts);
+
+			// Circles in the band above that can reach this one start at most a diameter to its left
+			if (b + 1 < m_Bands.size() && m_Bands[b + 1].y == m_Bands[b].y + 1)
+			{
+				if (cursorBand != b)
+				{
+					cursorBand = b;
+					cursor = m_Bands[b + 1].first;
+				}
+				const float reach = m_SortedMinX[row] - 2.0f * m_MaxRadius;
+				while (m_SortedMinX[cursor] < reach)
+					cursor++;
+				SweepRow(row, cursor, contacts);
+			}
+		}
+	});
+
+	size_t total = 0;
+	for (unsigned int c = 0; c < chunks; c++)
+		total += m_ChunkContacts[c].size();
+	m_Contacts.clear();
+	m_Contacts.reserve(total);
+	for (unsigned int c = 0; c < chunks; c++)
+		m_Contacts.insert(m_Contacts.end(), m_ChunkContacts[c].begin(), m_ChunkContacts[c].end());
+}
+
+void CirclePhysics::Solve(JobSystem& jobs, Scene& scene)
+{
+	const unsigned int count = scene.GetCount();
+	const unsigned int contactCount = (unsigned int)m_Contacts.size();
+	float* x = scene.GetX();
+	float* y = scene.GetY();
+	float* velocityX = scene.GetVelocityX();
+	float* velocityY = scene.GetVelocityY();
+	const float* radius = scene.GetRadius();
+
+	if (contactCount == 0)
+		return;
+
+	// Contacts per entity, in contact order
+	m_BodyStart.assign(count + 1, 0);
+	for (const CircleContact& contact : m_Contacts)
+	{
+		m_BodyStart[contact.a + 1]++;
+		m_BodyStart[contact.b + 1]++;
+	}
+	for (unsigned int i = 0; i < count; i++)
+		m_BodyStart[i + 1] += m_BodyStart[i];
+	m_BodyContacts.resize(2 * contactCount);
+	{
+		std::vector<unsigned int> cursor(m_BodyStart.begin(), m_BodyStart.end() - 1);
+		for (unsigned int c = 0; c < contactCount; c++)
+		{
+			m_BodyContacts[cursor[m_Contacts[c].a]++] = c;
+			m_BodyContacts[cursor[m_Contacts[c].b]++] = c;
+		}
+	}
+	m_Impulses.resize(contactCount);
+
+	// Mass is proportional to area
+	auto inverseMass = [radius](unsigned int i) { return 1.0f / (radius[i] * radius[i]); };
+
+	// Each entity adds its share of every impulse it takes part in, in contact order
+	auto apply = [&](float* targetX, float* targetY)
+	{
+		jobs.ParallelFor(count, PHYSICS_CHUNK_SIZE, [&](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int i = begin; i < end; i++)
+			{
+				const unsigned int first = m_BodyStart[i], last = m_BodyStart[i + 1];
+				if (first == last)
+					continue;
+
+				const float share = inverseMass(i) / (float)(last - first);
+				float sumX = 0.0f, sumY = 0.0f;
+				for (unsigned int k = first; k < last; k++)
+				{
+					const unsigned int c = m_BodyContacts[k];
+					const CircleContact& contact = m_Contacts[c];
+					const float impulse = contact.a == i ? -m_Impulses[c] : m_Impulses[c];
+					sumX += contact.normalX * impulse;
+					sumY += contact.normalY * impulse;
+				}
+				targetX[i] += sumX * share;
+				targetY[i] += sumY * share;
+			}
+		});
+	};
+
+	for (unsigned int iteration = 0; iteration < m_Iterations; iteration++)
+	{
+		jobs.ParallelFor(contactCount, PHYSICS_CHUNK_SIZE, [&](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int c = begin; c < end; c++)
+			{
+				const CircleContact& contact = m_Contacts[c];
+				const float approach = (velocityX[contact.b] - velocityX[contact.a]) * contact.normalX +
+					(velocityY[contact.b] - velocityY[contact.a]) * contact.normalY;
+				m_Impulses[c] = approach < 0.0f ?
+					-(1.0f + m_Restitution) * approach / (inverseMass(contact.a) + inverseMass(contact.b)) : 0.0f;
+			}
+		});
+		apply(velocityX, velocityY);
+	}
+
+	// Push the circles apart along the same normals
+	jobs.ParallelFor(contactCount, PHYSICS_CHUNK_SIZE, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int c = begin; c < end; c++)
+		{
+			const CircleContact& contact = m_Contacts[c];
+			m_Impulses[c] = POSITION_CORRECTION * contact.depth / (inverseMass(contact.a) + inverseMass(contact.b));
+		}
+	});
+	apply(x, y);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include<cstdint>
+#include<vector>
+
+#include "AABBTree.h"
+
+class JobSystem;
+class Scene;
+
+// Overlap between two entities, by dense index; the normal points from a to b
+struct CircleContact
+{
+	unsigned int a, b;
+	float normalX, normalY;
+	float depth;
+};
+
+struct PhysicsStats
+{
+	unsigned int Contacts = 0;
+	// Milliseconds spent in each stage of the last Step()
+	float IntegrateMs = 0.0f;
+	float SortMs = 0.0f;
+	float SweepMs = 0.0f;
+	float SolveMs = 0.0f;
+};
+
+// Collision between the circles of a Scene. Each step integrates, sorts the circles into
+// horizontal bands two largest radii tall and by left edge within a band, sweeps each band
+// and the one above it along x to find overlaps (testing a register of candidates at a
+// time), and resolves them with a few Jacobi iterations of impulses followed by a
+// position correction. Every stage runs on the job system, and the result does not
+// depend on the thread count: contacts are listed in sorted order, and each circle sums
+// the impulses of its own contacts in that order. A circle's share of each impulse is
+// divided by its contact count, so one wedged between many is not overcorrected.
+class CirclePhysics
+{
+private:
+	struct SortKey
+	{
+		// Band in the high half, sortable left edge in the low half
+		uint64_t key;
+		// Dense index, so ties are ordered too
+		unsigned int index;
+
+		inline bool operator<(const SortKey& other) const
+		{
+			return key < other.key || (key == other.key && index < other.index);
+		}
+	};
+
+	// A run of circles sharing a band, in m_Sorted* from first to first + count
+	struct Band
+	{
+		int y;
+		unsigned int first, count;
+	};
+
+	std::vector<SortKey> m_Keys, m_Scratch;
+	std::vector<Band> m_Bands;
+	// Circles in sorted order, every band followed by a register of sentinels
+	std::vector<float> m_SortedMinX, m_SortedX, m_SortedY, m_SortedRadius;
+	std::vector<unsigned int> m_SortedIndex;
+	// Band of each sorted row, ~0 for sentinels
+	std::vector<unsigned int> m_SortedBand;
+	float m_MaxRadius;
+	float m_BandHeight;
+
+	std::vector<std::vector<CircleContact>> m_ChunkContacts;
+	std::vector<CircleContact> m_Contacts;
+	// Per contact: impulse magnitude, or position correction in the final pass
+	std::vector<float> m_Impulses;
+	// Contacts of entity i are m_BodyContacts[m_BodyStart[i] .. m_BodyStart[i + 1]), ascending,
+	// so every entity can sum its own impulses in parallel and still in a fixed order
+	std::vector<unsigned int> m_BodyStart;
+	std::vector<unsigned int> m_BodyContacts;
+
+	AABB m_Bounds;
+	bool m_HasBounds;
+	float m_Restitution;
+	unsigned int m_Iterations;
+	PhysicsStats m_Stats;
+
+public:
+	CirclePhysics();
+
+	// Circles bounce off the inside of bounds
+	void SetBounds(const AABB& bounds);
+	void ClearBounds();
+	// 0 = contacts absorb the approaching velocity, 1 = perfectly elastic
+	inline void SetRestitution(float restitution) { m_Restitution = restitution; }
+	inline void SetIterations(unsigned int iterations) { m_Iterations = iterations; }
+
+	void Step(JobSystem& jobs, Scene& scene, float dt);
+
+	// Contacts found by the last Step(), in a deterministic order
+	inline const std::vector<CircleContact>& GetContacts() const { return m_Contacts; }
+	inline const PhysicsStats& GetStats() const { return m_Stats; }
+
+private:
+	void Integrate(JobSystem& jobs, Scene& scene, float dt);
+	void Sort(JobSystem& jobs, const Scene& scene);
+	void Sweep(JobSystem& jobs);
+	// Tests row against the circles from first on, until one starts right of its right edge
+	void SweepRow(unsigned int row, unsigned int first, std::vector<CircleContact>& contacts) const;
+	void Solve(JobSystem& jobs, Scene& scene);
+};
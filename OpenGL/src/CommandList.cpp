@@ -0,0 +1,140 @@
+#include "CommandList.h"
+#include "JobSystem.h"
+#include "Renderer.h"
+
+CommandList::Command& CommandList::Push(CommandType type)
+{
+	m_Commands.emplace_back();
+	Command& command = m_Commands.back();
+	command.type = type;
+	return command;
+}
+
+void CommandList::BindShader(ShaderHandle shader)
+{
+	Push(CommandType::BindShader).handle = shader.index;
+}
+
+void CommandList::BindVertexArray(VertexArrayHandle va)
+{
+	Push(CommandType::BindVertexArray).handle = va.index;
+}
+
+void CommandList::BindVertexBuffer(VertexBufferHandle vb)
+{
+	Push(CommandType::BindVertexBuffer).handle = vb.index;
+}
+
+void CommandList::BindIndexBuffer(IndexBufferHandle ib)
+{
+	Push(CommandType::BindIndexBuffer).handle = ib.index;
+}
+
+void CommandList::SetUniform1f(const char* name, float v0)
+{
+	Command& command = Push(CommandType::SetUniform1f);
+	command.uniform = name;
+	command.values[0] = v0;
+}
+
+void CommandList::SetUniform2f(const char* name, float v0, float v1)
+{
+	Command& command = Push(CommandType::SetUniform2f);
+	command.uniform = name;
+	command.values[0] = v0;
+	command.values[1] = v1;
+}
+
+void CommandList::SetUniform4f(const char* name, float v0, float v1, float v2, float v3)
+{
+	Command& command = Push(CommandType::SetUniform4f);
+	command.uniform = name;
+	command.values[0] = v0;
+	command.values[1] = v1;
+	command.values[2] = v2;
+	command.values[3] = v3;
+}
+
+void CommandList::DrawElements(unsigned int mode, unsigned int count, unsigned int firstIndex)
+{
+	Command& command = Push(CommandType::DrawElements);
+	command.mode = mode;
+	command.count = count;
+	command.firstIndex = firstIndex;
+}
+
+void CommandList::Execute(const RenderResources& resources) const
+{
+	Shader* shader = nullptr;
+	const VertexArray* va = nullptr;
+	const IndexBuffer* ib = nullptr;
+
+	for (const Command& command : m_Commands)
+	{
+		switch (command.type)
+		{
+		case CommandType::BindShader:
+			shader = resources.Get(ShaderHandle{ command.handle });
+			shader->Bind();
+			break;
+		case CommandType::BindVertexArray:
+			va = resources.Get(VertexArrayHandle{ command.handle });
+			va->Bind();
+			break;
+		case CommandType::BindVertexBuffer:
+			ASSERT(va);
+			va->BindVertexBuffer(*resources.Get(VertexBufferHandle{ command.handle }));
+			break;
+		case CommandType::BindIndexBuffer:
+			ib = resources.Get(IndexBufferHandle{ command.handle });
+			ib->Bind();
+			break;
+		case CommandType::SetUniform1f:
+			ASSERT(shader);
+			shader->SetUniform1f(command.uniform, command.values[0]);
+			break;
+		case CommandType::SetUniform2f:
+			ASSERT(shader);
+			shader->SetUniform2f(command.uniform, command.values[0], command.values[1]);
+			break;
+		case CommandType::SetUniform4f:
+			ASSERT(shader);
+			shader->SetUniform4f(command.uniform, command.values[0], command.values[1], command.values[2], command.values[3]);
+			break;
+		case CommandType::DrawElements:
+		{
+			ASSERT(ib);
+			unsigned int count = command.count ? command.count : ib->GetCount() - command.firstIndex;
+			glDrawElements(command.mode, count, GL_UNSIGNED_INT, (const void*)(command.firstIndex * sizeof(unsigned int)));
+			break;
+		}
+		}
+	}
+}
+
+void RecordCommandListsParallel(JobSystem& jobs, std::vector<CommandList>& lists, unsigned int count, unsigned int chunkSize,
+	void (*record)(CommandList& list, unsigned int begin, unsigned int end, void* user), void* user)
+{
+	if (chunkSize == 0)
+		chunkSize = 1;
+
+	const unsigned int chunks = (count + chunkSize - 1) / chunkSize;
+	lists.resize(chunks);
+
+	jobs.ParallelFor(chunks, 1, [&](unsigned int first, unsigned int last)
+	{
+		for (unsigned int chunk = first; chunk < last; chunk++)
+		{
+			unsigned int begin = chunk * chunkSize;
+			unsigned int end = begin + chunkSize < count ? begin + chunkSize : count;
+			lists[chunk].Reset();
+			record(lists[chunk], begin, end, user);
+		}
+	});
+}
+
+void ExecuteCommandLists(const std::vector<CommandList>& lists, const RenderResources& resources)
+{
+	for (const CommandList& list : lists)
+		list.Execute(resources);
+}
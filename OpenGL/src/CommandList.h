@@ -0,0 +1,63 @@
+#pragma once
+
+#include<vector>
+
+#include "RenderResources.h"
+
+class JobSystem;
+
+// Deferred GL commands recorded into plain memory. Any thread may record into its
+// own list; only the thread owning the GL context may Execute() it.
+class CommandList
+{
+private:
+	enum class CommandType : unsigned char
+	{
+		BindShader, BindVertexArray, BindVertexBuffer, BindIndexBuffer,
+		SetUniform1f, SetUniform2f, SetUniform4f, DrawElements
+	};
+
+	struct Command
+	{
+		CommandType type;
+		unsigned int handle;
+		// Must outlive execution, e.g. a string literal
+		const char* uniform;
+		float values[4];
+		unsigned int mode;
+		unsigned int count;
+		unsigned int firstIndex;
+	};
+
+	std::vector<Command> m_Commands;
+
+public:
+	inline void Reset() { m_Commands.clear(); }
+	inline void Reserve(unsigned int commands) { m_Commands.reserve(commands); }
+	inline unsigned int GetSize() const { return (unsigned int)m_Commands.size(); }
+
+	void BindShader(ShaderHandle shader);
+	void BindVertexArray(VertexArrayHandle va);
+	// For vertex arrays that only describe a format (see VertexArrayCache)
+	void BindVertexBuffer(VertexBufferHandle vb);
+	void BindIndexBuffer(IndexBufferHandle ib);
+	void SetUniform1f(const char* name, float v0);
+	void SetUniform2f(const char* name, float v0, float v1);
+	void SetUniform4f(const char* name, float v0, float v1, float v2, float v3);
+	// count 0 draws the whole bound index buffer
+	void DrawElements(unsigned int mode, unsigned int count = 0, unsigned int firstIndex = 0);
+
+	void Execute(const RenderResources& resources) const;
+
+private:
+	Command& Push(CommandType type);
+};
+
+// Splits [0, count) into chunks, records chunk i into lists[i] on the job system's
+// threads, then leaves the lists ready to execute in order. Output order matches a
+// serial recording regardless of which thread recorded which chunk.
+void RecordCommandListsParallel(JobSystem& jobs, std::vector<CommandList>& lists, unsigned int count, unsigned int chunkSize,
+	void (*record)(CommandList& list, unsigned int begin, unsigned int end, void* user), void* user);
+
+// Replays lists in order on the GL thread
+void ExecuteCommandLists(const std::vector<CommandList>& lists, const RenderResources& resources);
@@ -0,0 +1,29 @@
+#include "FixedTimestep.h"
+
+FixedTimestep::FixedTimestep(double step, unsigned int maxSteps)
+	: m_Step(step), m_Accumulator(0.0), m_LastTime(0.0), m_MaxSteps(maxSteps), m_Started(false)
+{
+}
+
+unsigned int FixedTimestep::Advance(double time)
+{
+	if (!m_Started)
+	{
+		m_LastTime = time;
+		m_Started = true;
+		return 0;
+	}
+
+	m_Accumulator += time - m_LastTime;
+	m_LastTime = time;
+
+	unsigned int steps = 0;
+	while (m_Accumulator >= m_Step && steps < m_MaxSteps)
+	{
+		m_Accumulator -= m_Step;
+		steps++;
+	}
+	if (steps == m_MaxSteps && m_Accumulator >= m_Step)
+		m_Accumulator = 0.0;
+	return steps;
+}
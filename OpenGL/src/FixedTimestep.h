@@ -0,0 +1,25 @@
+#pragma once
+
+// Turns variable frame times into a whole number of fixed-length steps, so simulation
+// results don't depend on the frame rate. Time that doesn't fill a step carries over to
+// the next frame; after a long stall at most maxSteps are run and the rest is dropped,
+// rather than falling further behind.
+class FixedTimestep
+{
+private:
+	double m_Step;
+	double m_Accumulator;
+	double m_LastTime;
+	unsigned int m_MaxSteps;
+	bool m_Started;
+
+public:
+	explicit FixedTimestep(double step = 1.0 / 60.0, unsigned int maxSteps = 4);
+
+	// Returns how many steps to run this frame, given the current time in seconds
+	unsigned int Advance(double time);
+
+	inline float GetStep() const { return (float)m_Step; }
+	// How far into the next step the frame is, in [0, 1), e.g. to interpolate for drawing
+	inline float GetAlpha() const { return (float)(m_Accumulator / m_Step); }
+};
@@ -0,0 +1,273 @@
+#include "GLState.h"
+#include "Renderer.h"
+
+// Each thread starts with a tracker of its own, so threads never share shadow state
+static thread_local GLState s_DefaultState;
+static thread_local GLState* s_CurrentState = nullptr;
+
+GLState::GLState()
+	: m_Issued(0), m_Eliminated(0)
+{
+	Invalidate();
+}
+
+GLState& GLState::Get()
+{
+	return s_CurrentState ? *s_CurrentState : s_DefaultState;
+}
+
+void GLState::MakeCurrent(GLState* state)
+{
+	s_CurrentState = state;
+}
+
+void GLState::UseProgram(unsigned int program)
+{
+	if (Changed(m_Program != program))
+	{
+		glUseProgram(program);
+		m_Program = program;
+	}
+}
+
+void GLState::BindVertexArray(unsigned int vertexArray)
+{
+	if (Changed(m_VertexArray != vertexArray))
+	{
+		glBindVertexArray(vertexArray);
+		m_VertexArray = vertexArray;
+	}
+}
+
+void GLState::BindBuffer(unsigned int target, unsigned int buffer)
+{
+	unsigned int* bound;
+	if (target == GL_ARRAY_BUFFER)
+	{
+		bound = &m_ArrayBuffer;
+	}
+	else if (target == GL_ELEMENT_ARRAY_BUFFER)
+	{
+		if (m_VertexArray == Unknown)
+		{
+			m_Issued++;
+			glBindBuffer(target, buffer);
+			return;
+		}
+		auto it = m_ElementBuffers.find(m_VertexArray);
+		if (it == m_ElementBuffers.end())
+			it = m_ElementBuffers.insert({ m_VertexArray, Unknown }).first;
+		bound = &it->second;
+	}
+	else
+	{
+		auto it = m_OtherBuffers.find(target);
+		if (it == m_OtherBuffers.end())
+			it = m_OtherBuffers.insert({ target, Unknown }).first;
+		bound = &it->second;
+	}
+
+	if (Changed(*bound != buffer))
+	{
+		glBindBuffer(target, buffer);
+		*bound = buffer;
+	}
+}
+
+void GLState::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+{
+	m_Issued++;
+	glBindBufferBase(target, index, buffer);
+	m_OtherBuffers[target] = buffer;
+}
+
+void GLState::BindTexture(unsigned int unit, unsigned int target, unsigned int texture)
+{
+	ASSERT(unit < MaxTextureUnits);
+
+	TextureBinding& bound = m_Textures[unit];
+	if (!Changed(bound.target != target || bound.id != texture))
+		return;
+
+	if (GLGetCapabilities().DirectStateAccess && texture != 0)
+	{
+		glBindTextureUnit(unit, texture);
+	}
+	else
+	{
+		if (m_ActiveTextureUnit != unit)
+		{
+			m_Issued++;
+			glActiveTexture(GL_TEXTURE0 + unit);
+			m_ActiveTextureUnit = unit;
+		}
+		glBindTexture(target, texture);
+	}
+	bound.target = target;
+	bound.id = texture;
+}
+
+void GLState::SetBlend(bool enabled)
+{
+	if (Changed(m_Blend != (int)enabled))
+	{
+		if (enabled)
+			glEnable(GL_BLEND);
+		else
+			glDisable(GL_BLEND);
+		m_Blend = enabled;
+	}
+}
+
+void GLState::BlendFunc(unsigned int src, unsigned int dst)
+{
+	if (Changed(m_BlendSrc != src || m_BlendDst != dst))
+	{
+		glBlendFunc(src, dst);
+		m_BlendSrc = src;
+		m_BlendDst = dst;
+	}
+}
+
+void GLState::SetDepthTest(bool enabled)
+{
+	if (Changed(m_DepthTest != (int)enabled))
+	{
+		if (enabled)
+			glEnable(GL_DEPTH_TEST);
+		else
+			glDisable(GL_DEPTH_TEST);
+		m_DepthTest = enabled;
+	}
+}
+
+void GLState::DepthFunc(unsigned int func)
+{
+	if (Changed(m_DepthFunc != func))
+	{
+		glDepthFunc(func);
+		m_DepthFunc = func;
+	}
+}
+
+void GLState::SetPrimitiveRestart(bool enabled)
+{
+	if (!Changed(m_PrimitiveRestart != (int)enabled))
+		return;
+
+	if (GLGetCapabilities().PrimitiveRestartFixedIndex)
+	{
+		if (enabled)
+			glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+		else
+			glDisable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+	}
+	else
+	{
+		if (enabled)
+		{
+			glEnable(GL_PRIMITIVE_RESTART);
+			glPrimitiveRestartIndex(0xFFFFFFFF);
+		}
+		else
+		{
+			glDisable(GL_PRIMITIVE_RESTART);
+		}
+	}
+	m_PrimitiveRestart = enabled;
+}
+
+void GLState::Viewport(int x, int y, int width, int height)
+{
+	if (Changed(m_Viewport[0] != x || m_Viewport[1] != y || m_Viewport[2] != width || m_Viewport[3] != height))
+	{
+		glViewport(x, y, width, height);
+		m_Viewport[0] = x;
+		m_Viewport[1] = y;
+		m_Viewport[2] = width;
+		m_Viewport[3] = height;
+	}
+}
+
+void GLState::BindFramebuffer(unsigned int framebuffer)
+{
+	if (Changed(m_Framebuffer != framebuffer))
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		m_Framebuffer = framebuffer;
+	}
+}
+
+void GLState::OnProgramDeleted(unsigned int program)
+{
+	// Deleting the current program leaves it in use until another one is bound
+	if (m_Program == program)
+		m_Program = Unknown;
+}
+
+void GLState::OnVertexArrayDeleted(unsigned int vertexArray)
+{
+	m_ElementBuffers.erase(vertexArray);
+	if (m_VertexArray == vertexArray)
+		m_VertexArray = 0;
+}
+
+void GLState::OnBufferDeleted(unsigned int buffer)
+{
+	// GL unbinds a deleted buffer from the current context's binding points
+	if (m_ArrayBuffer == buffer)
+		m_ArrayBuffer = 0;
+	for (auto& binding : m_OtherBuffers)
+	{
+		if (binding.second == buffer)
+			binding.second = 0;
+	}
+	for (auto& binding : m_ElementBuffers)
+	{
+		if (binding.second == buffer)
+			binding.second = binding.first == m_VertexArray ? 0 : Unknown;
+	}
+}
+
+void GLState::OnTextureDeleted(unsigned int texture)
+{
+	for (auto& binding : m_Textures)
+	{
+		if (binding.id == texture)
+			binding.id = 0;
+	}
+}
+
+void GLState::OnFramebufferDeleted(unsigned int framebuffer)
+{
+	// Deleting the bound framebuffer reverts to the default one
+	if (m_Framebuffer == framebuffer)
+		m_Framebuffer = 0;
+}
+
+void GLState::OnElementBufferAttached(unsigned int vertexArray, unsigned int buffer)
+{
+	m_ElementBuffers[vertexArray] = buffer;
+}
+
+void GLState::Invalidate()
+{
+	m_Program = Unknown;
+	m_VertexArray = Unknown;
+	m_ArrayBuffer = Unknown;
+	m_ElementBuffers.clear();
+	m_OtherBuffers.clear();
+	m_ActiveTextureUnit = Unknown;
+	for (auto& binding : m_Textures)
+	{
+		binding.target = Unknown;
+		binding.id = Unknown;
+	}
+	m_Blend = -1;
+	m_BlendSrc = m_BlendDst = Unknown;
+	m_DepthTest = -1;
+	m_DepthFunc = Unknown;
+	m_PrimitiveRestart = -1;
+	m_Viewport[0] = m_Viewport[1] = m_Viewport[2] = m_Viewport[3] = -1;
+	m_Framebuffer = Unknown;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include<unordered_map>
+
+// Shadows the GL binding state of one context so redundant binds never reach the driver.
+// Every bind in the renderer goes through here; code that touches GL state directly
+// must call Invalidate() afterwards.
+class GLState
+{
+public:
+	static const unsigned int Unknown = 0xFFFFFFFF;
+	static const unsigned int MaxTextureUnits = 32;
+
+private:
+	struct TextureBinding
+	{
+		unsigned int target;
+		unsigned int id;
+	};
+
+	unsigned int m_Program;
+	unsigned int m_VertexArray;
+	unsigned int m_ArrayBuffer;
+	// The element array binding belongs to the vertex array, so it is tracked per vertex array
+	std::unordered_map<unsigned int, unsigned int> m_ElementBuffers;
+	std::unordered_map<unsigned int, unsigned int> m_OtherBuffers;
+	unsigned int m_ActiveTextureUnit;
+	TextureBinding m_Textures[MaxTextureUnits];
+	int m_Blend;
+	unsigned int m_BlendSrc, m_BlendDst;
+	int m_DepthTest;
+	unsigned int m_DepthFunc;
+	int m_PrimitiveRestart;
+	int m_Viewport[4];
+	unsigned int m_Framebuffer;
+
+	unsigned int m_Issued;
+	unsigned int m_Eliminated;
+
+public:
+	GLState();
+
+	// Tracker for the context current on this thread; until MakeCurrent, the thread's own default
+	static GLState& Get();
+	// Pass null to go back to the thread's default tracker
+	static void MakeCurrent(GLState* state);
+
+	void UseProgram(unsigned int program);
+	void BindVertexArray(unsigned int vertexArray);
+	void BindBuffer(unsigned int target, unsigned int buffer);
+	// Indexed binding points are not tracked; this always issues, and records that GL
+	// also binds the buffer to the target's generic binding point
+	void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer);
+	void BindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+	void SetBlend(bool enabled);
+	void BlendFunc(unsigned int src, unsigned int dst);
+	void SetDepthTest(bool enabled);
+	void DepthFunc(unsigned int func);
+	// Restart on PRIMITIVE_RESTART_INDEX (0xFFFFFFFF) for GL_UNSIGNED_INT indices
+	void SetPrimitiveRestart(bool enabled);
+	void Viewport(int x, int y, int width, int height);
+	// Binds both the draw and read framebuffer
+	void BindFramebuffer(unsigned int framebuffer);
+
+	// Keep the shadow state correct when objects are deleted or edited with DSA
+	void OnProgramDeleted(unsigned int program);
+	void OnVertexArrayDeleted(unsigned int vertexArray);
+	void OnBufferDeleted(unsigned int buffer);
+	void OnTextureDeleted(unsigned int texture);
+	void OnFramebufferDeleted(unsigned int framebuffer);
+	void OnElementBufferAttached(unsigned int vertexArray, unsigned int buffer);
+
+	// Forget everything, e.g. after third-party code issued raw GL calls
+	void Invalidate();
+
+	inline unsigned int GetProgram() const { return m_Program; }
+	inline unsigned int GetVertexArray() const { return m_VertexArray; }
+	inline unsigned int GetIssuedCount() const { return m_Issued; }
+	inline unsigned int GetEliminatedCount() const { return m_Eliminated; }
+	inline void ResetCounters() { m_Issued = m_Eliminated = 0; }
+
+private:
+	inline bool Changed(bool changed)
+	{
+		if (changed)
+			m_Issued++;
+		else
+			m_Eliminated++;
+		return changed;
+	}
+};
@@ -0,0 +1,163 @@
+#include "GPUCuller.h"
+#include "IndirectDrawBuilder.h"
+#include "GLState.h"
+#include "Shader.h"
+#include "Renderer.h"
+
+#include<cstring>
+
+// Must match local_size_x in CullCircles.shader
+const unsigned int CULL_GROUP_SIZE = 256;
+
+unsigned int CullCircleInstances(const CircleInstance* instances, unsigned int count, const AABB& view, CircleInstance* out)
+{
+	unsigned int written = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const CircleInstance& instance = instances[i];
+		if (instance.x + instance.radius >= view.minX && instance.x - instance.radius <= view.maxX &&
+			instance.y + instance.radius >= view.minY && instance.y - instance.radius <= view.maxY)
+			out[written++] = instance;
+	}
+	return written;
+}
+
+GPUCuller::GPUCuller(unsigned int capacity)
+	: m_Visible(capacity * (unsigned int)sizeof(CircleInstance)), m_IndirectBuffer(0), m_CullShader(nullptr),
+	m_Capacity(capacity), m_CPUVisibleCount(0)
+{
+	if (GLGetCapabilities().ComputeShader)
+	{
+		m_CullShader = new Shader("res/Shaders/CullCircles.shader");
+		if (!m_CullShader->IsValid())
+		{
+			delete m_CullShader;
+			m_CullShader = nullptr;
+		}
+	}
+	if (!m_CullShader)
+	{
+		m_CPUVisible.resize(capacity);
+		return;
+	}
+
+	DrawElementsIndirectCommand command = {};
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		glCreateBuffers(1, &m_IndirectBuffer);
+		glNamedBufferData(m_IndirectBuffer, sizeof(command), &command, GL_DYNAMIC_DRAW);
+	}
+	else
+	{
+		glGenBuffers(1, &m_IndirectBuffer);
+		GLState::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(command), &command, GL_DYNAMIC_DRAW);
+	}
+}
+
+GPUCuller::~GPUCuller()
+{
+	delete m_CullShader;
+	if (m_IndirectBuffer)
+	{
+		GLState::Get().OnBufferDeleted(m_IndirectBuffer);
+		glDeleteBuffers(1, &m_IndirectBuffer);
+	}
+}
+
+void GPUCuller::Cull(const VertexBuffer& instances, const CircleInstance* cpuInstances, unsigned int count, const AABB& view)
+{
+	ASSERT(count <= m_Capacity);
+
+	if (!m_CullShader)
+	{
+		ASSERT(cpuInstances || count == 0);
+		m_CPUVisibleCount = CullCircleInstances(cpuInstances, count, view, m_CPUVisible.data());
+		if (m_CPUVisibleCount > 0)
+		{
+			// Only the front of the buffer is drawn, so leave the rest as it is
+			void* mapped = m_Visible.Map(0, m_CPUVisibleCount * sizeof(CircleInstance));
+			ASSERT(mapped);
+			memcpy(mapped, m_CPUVisible.data(), m_CPUVisibleCount * sizeof(CircleInstance));
+			m_Visible.FlushMappedRange(0, m_CPUVisibleCount * sizeof(CircleInstance));
+			if (!m_Visible.Unmap())
+				m_CPUVisibleCount = 0;
+		}
+		return;
+	}
+
+	GLState& state = GLState::Get();
+
+	// Restart the append cursor; the draw parameters are filled in by Draw()
+	const GLuint zero = 0;
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		glNamedBufferSubData(m_IndirectBuffer, sizeof(GLuint), sizeof(GLuint), &zero);
+	}
+	else
+	{
+		state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, sizeof(GLuint), sizeof(GLuint), &zero);
+	}
+
+	if (count == 0)
+		return;
+
+	const unsigned int groups = (count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+	ASSERT(groups <= 65535);
+
+	m_CullShader->Bind();
+	m_CullShader->SetUniform4f("u_View", view.minX, view.minY, view.maxX, view.maxY);
+	m_CullShader->SetUniform1ui("u_Count", count);
+	state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instances.GetRendererID());
+	state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_Visible.GetRendererID());
+	state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_IndirectBuffer);
+	glDispatchCompute(groups, 1, 1);
+
+	// The results are read as draw parameters, as instance attributes, and by buffer updates
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+void GPUCuller::Draw(CircleLODMeshes& meshes, unsigned char level)
+{
+	if (!m_CullShader)
+	{
+		meshes.Draw(level, m_Visible, 0, m_CPUVisibleCount);
+		return;
+	}
+
+	// Everything but instanceCount, which the last Cull() wrote
+	const GLuint count = meshes.GetIndexCount(level);
+	const GLuint rest[3] = { meshes.GetFirstIndex(level), (GLuint)meshes.GetBaseVertex(level), 0 };
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		glNamedBufferSubData(m_IndirectBuffer, 0, sizeof(count), &count);
+		glNamedBufferSubData(m_IndirectBuffer, 2 * sizeof(GLuint), sizeof(rest), rest);
+	}
+	else
+	{
+		GLState::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(count), &count);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 2 * sizeof(GLuint), sizeof(rest), rest);
+	}
+
+	meshes.DrawIndirect(m_Visible, m_IndirectBuffer, 0);
+}
+
+unsigned int GPUCuller::ReadVisibleCount() const
+{
+	if (!m_CullShader)
+		return m_CPUVisibleCount;
+
+	GLuint count = 0;
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		glGetNamedBufferSubData(m_IndirectBuffer, sizeof(GLuint), sizeof(GLuint), &count);
+	}
+	else
+	{
+		GLState::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+		glGetBufferSubData(GL_DRAW_INDIRECT_BUFFER, sizeof(GLuint), sizeof(GLuint), &count);
+	}
+	return count;
+}
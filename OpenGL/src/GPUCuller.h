@@ -0,0 +1,53 @@
+#pragma once
+
+#include<vector>
+
+#include "AABBTree.h"
+#include "CircleLOD.h"
+
+class Shader;
+
+// CPU reference for GPUCuller: copies the instances whose bounds overlap view into out,
+// in order. Returns the number written.
+unsigned int CullCircleInstances(const CircleInstance* instances, unsigned int count, const AABB& view, CircleInstance* out);
+
+// Viewport culling of CircleInstance records on the GPU. CullCircles.shader reads every
+// instance from the source buffer, appends the survivors to a compact buffer of its own
+// and counts them straight into a DrawElementsIndirectCommand, so Draw() never waits for
+// the result and the CPU never touches per-instance data. The survivors' order is not
+// deterministic. Contexts without compute shaders cull with CullCircleInstances instead,
+// which needs a CPU copy of the instances, and draw with a plain instanced call.
+class GPUCuller
+{
+private:
+	VertexBuffer m_Visible;
+	unsigned int m_IndirectBuffer;
+	Shader* m_CullShader;
+	unsigned int m_Capacity;
+	// Fallback path only
+	std::vector<CircleInstance> m_CPUVisible;
+	unsigned int m_CPUVisibleCount;
+
+public:
+	// capacity is the most instances a single Cull() may be given
+	explicit GPUCuller(unsigned int capacity);
+	~GPUCuller();
+
+	GPUCuller(const GPUCuller&) = delete;
+	GPUCuller& operator=(const GPUCuller&) = delete;
+
+	// Culls count records of instances against view. cpuInstances must hold the same
+	// records when compute shaders are unavailable and may be null otherwise.
+	void Cull(const VertexBuffer& instances, const CircleInstance* cpuInstances, unsigned int count, const AABB& view);
+
+	// Draws the survivors of the last Cull() at the given level. Circle.shader must be bound
+	// and the meshes given a CircleInstance layout with SetInstanceBuffer().
+	void Draw(CircleLODMeshes& meshes, unsigned char level);
+
+	// Reads the survivor count back, waiting for the GPU; for debugging and validation
+	unsigned int ReadVisibleCount() const;
+
+	// Compact survivors, CircleInstance records
+	inline const VertexBuffer& GetVisibleBuffer() const { return m_Visible; }
+	inline bool IsGPUPath() const { return m_CullShader != nullptr; }
+};
@@ -0,0 +1,230 @@
+#include "GPUParticleSystem.h"
+#include "GLState.h"
+#include "Shader.h"
+#include "Renderer.h"
+
+#include<cmath>
+
+// Must match local_size_x in ParticleSimulate.shader
+const unsigned int PARTICLE_GROUP_SIZE = 256;
+
+// The uniforms of one update, worked out once so the shaders and the CPU reference agree
+struct ParticleStepParameters
+{
+	float dt;
+	unsigned int stepSeed;
+	float x, y;
+	float angle, spread;
+	float minSpeed, speedRange;
+	float minLifetime, lifetimeRange;
+	float damping;
+	float gravityX, gravityY;
+};
+
+// PCG output permutation, as in the shaders
+static inline unsigned int Hash(unsigned int x)
+{
+	const unsigned int state = x * 747796405u + 2891336453u;
+	const unsigned int word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+	return (word >> 22u) ^ word;
+}
+
+static inline float Unit(unsigned int x)
+{
+	return (float)(x >> 8u) * (1.0f / 16777216.0f);
+}
+
+static ParticleStepParameters GetStepParameters(const ParticleEmitter& emitter, float dt, unsigned int step, unsigned int seed)
+{
+	ParticleStepParameters parameters;
+	parameters.dt = dt;
+	parameters.stepSeed = Hash(Hash(seed) + step);
+	parameters.x = emitter.x;
+	parameters.y = emitter.y;
+	parameters.angle = emitter.angle;
+	parameters.spread = emitter.spread;
+	parameters.minSpeed = emitter.minSpeed;
+	parameters.speedRange = emitter.maxSpeed - emitter.minSpeed;
+	parameters.minLifetime = emitter.minLifetime;
+	parameters.lifetimeRange = emitter.maxLifetime - emitter.minLifetime;
+	parameters.damping = std::pow(emitter.damping, dt);
+	parameters.gravityX = emitter.gravityX * dt;
+	parameters.gravityY = emitter.gravityY * dt;
+	return parameters;
+}
+
+static VertexBufferLayout GetParticleLayout()
+{
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	layout.Push<float>(2);
+	layout.Push<float>(1);
+	layout.Push<float>(1);
+	return layout;
+}
+
+void StepGPUParticles(GPUParticle* particles, unsigned int count, const ParticleEmitter& emitter, float dt, unsigned int step, unsigned int seed)
+{
+	const ParticleStepParameters parameters = GetStepParameters(emitter, dt, step, seed);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		GPUParticle& particle = particles[i];
+		particle.age = particle.age + parameters.dt;
+
+		if (particle.age >= particle.lifetime)
+		{
+			const unsigned int h = Hash(parameters.stepSeed ^ i);
+			const float angle = parameters.angle + (2.0f * Unit(Hash(h)) - 1.0f) * parameters.spread;
+			const float speed = parameters.minSpeed + parameters.speedRange * Unit(Hash(h + 1u));
+			particle.x = parameters.x;
+			particle.y = parameters.y;
+			particle.velocityX = std::cos(angle) * speed;
+			particle.velocityY = std::sin(angle) * speed;
+			particle.age = 0.0f;
+			particle.lifetime = parameters.minLifetime + parameters.lifetimeRange * Unit(Hash(h + 2u));
+		}
+		else if (particle.age >= 0.0f)
+		{
+			particle.velocityX = particle.velocityX * parameters.damping + parameters.gravityX;
+			particle.velocityY = particle.velocityY * parameters.damping + parameters.gravityY;
+			particle.x = particle.x + particle.velocityX * parameters.dt;
+			particle.y = particle.y + particle.velocityY * parameters.dt;
+		}
+	}
+}
+
+GPUParticleSystem::GPUParticleSystem(unsigned int capacity, unsigned int seed, bool allowCompute)
+	: m_Current(0), m_UpdateArray(GetParticleLayout()), m_UpdateShader(nullptr), m_RenderShader(nullptr),
+	m_Compute(allowCompute && GLGetCapabilities().ComputeShader), m_Capacity(capacity), m_Step(0), m_Seed(seed)
+{
+	const unsigned int size = capacity * (unsigned int)sizeof(GPUParticle);
+	m_Buffers[0] = new VertexBuffer(size);
+	m_Buffers[1] = new VertexBuffer(size);
+
+	if (m_Compute)
+	{
+		m_UpdateShader = new Shader("res/Shaders/ParticleSimulate.shader");
+		// Transform feedback works wherever the compute shader fails to build
+		if (!m_UpdateShader->IsValid())
+		{
+			delete m_UpdateShader;
+			m_UpdateShader = nullptr;
+			m_Compute = false;
+		}
+	}
+	if (!m_UpdateShader)
+		m_UpdateShader = new Shader("res/Shaders/ParticleUpdate.shader");
+	m_RenderShader = new Shader("res/Shaders/ParticleRender.shader");
+
+	// Position and velocity, then age and lifetime, as instance attributes 1 and 2
+	VertexBufferLayout instanceLayout;
+	instanceLayout.Push<float>(4);
+	instanceLayout.Push<float>(2);
+	m_Meshes.SetInstanceBuffer(*m_Buffers[0], instanceLayout);
+
+	Reset();
+}
+
+GPUParticleSystem::~GPUParticleSystem()
+{
+	delete m_RenderShader;
+	delete m_UpdateShader;
+	delete m_Buffers[1];
+	delete m_Buffers[0];
+}
+
+void GPUParticleSystem::Reset()
+{
+	std::vector<GPUParticle> particles(m_Capacity);
+	const float interval = m_Emitter.rate > 0.0f ? 1.0f / m_Emitter.rate : 1e30f;
+	for (unsigned int i = 0; i < m_Capacity; i++)
+	{
+		GPUParticle& particle = particles[i];
+		particle.x = m_Emitter.x;
+		particle.y = m_Emitter.y;
+		particle.velocityX = particle.velocityY = 0.0f;
+		particle.age = -interval * (float)i;
+		particle.lifetime = 0.0f;
+	}
+
+	m_Current = 0;
+	m_Step = 0;
+	m_Buffers[0]->SetData(particles.data(), m_Capacity * (unsigned int)sizeof(GPUParticle));
+}
+
+void GPUParticleSystem::Update(float dt)
+{
+	const ParticleStepParameters parameters = GetStepParameters(m_Emitter, dt, m_Step, m_Seed);
+	const VertexBuffer& source = *m_Buffers[m_Current];
+	const VertexBuffer& destination = *m_Buffers[1 - m_Current];
+	GLState& state = GLState::Get();
+
+	Shader& shader = *m_UpdateShader;
+	shader.Bind();
+	shader.SetUniform1f("u_DeltaTime", parameters.dt);
+	shader.SetUniform1ui("u_StepSeed", parameters.stepSeed);
+	shader.SetUniform2f("u_Emitter", parameters.x, parameters.y);
+	shader.SetUniform2f("u_Direction", parameters.angle, parameters.spread);
+	shader.SetUniform2f("u_Speed", parameters.minSpeed, parameters.speedRange);
+	shader.SetUniform2f("u_LifetimeRange", parameters.minLifetime, parameters.lifetimeRange);
+	shader.SetUniform1f("u_Damping", parameters.damping);
+	shader.SetUniform2f("u_Gravity", parameters.gravityX, parameters.gravityY);
+
+	if (m_Compute)
+	{
+		shader.SetUniform1ui("u_Count", m_Capacity);
+		state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, source.GetRendererID());
+		state.BindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, destination.GetRendererID());
+		glDispatchCompute((m_Capacity + PARTICLE_GROUP_SIZE - 1) / PARTICLE_GROUP_SIZE, 1, 1);
+
+		// The results are read as instance attributes, by the next dispatch, and by Read()
+		glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+	}
+	else
+	{
+		m_UpdateArray.Bind();
+		m_UpdateArray.BindVertexBuffer(source);
+		state.BindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, destination.GetRendererID());
+
+		glEnable(GL_RASTERIZER_DISCARD);
+		glBeginTransformFeedback(GL_POINTS);
+		glDrawArrays(GL_POINTS, 0, m_Capacity);
+		glEndTransformFeedback();
+		glDisable(GL_RASTERIZER_DISCARD);
+
+		// A buffer may not be a vertex source while it is also bound for capture
+		state.BindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	}
+
+	m_Current = 1 - m_Current;
+	m_Step++;
+}
+
+void GPUParticleSystem::Draw(unsigned char level)
+{
+	Shader& shader = *m_RenderShader;
+	shader.Bind();
+	shader.SetUniform2f("u_Radius", m_Emitter.startRadius, m_Emitter.endRadius);
+	const float* start = m_Emitter.startColor;
+	const float* end = m_Emitter.endColor;
+	shader.SetUniform4f("u_StartColor", start[0], start[1], start[2], start[3]);
+	shader.SetUniform4f("u_EndColor", end[0], end[1], end[2], end[3]);
+
+	m_Meshes.Draw(level, *m_Buffers[m_Current], 0, m_Capacity);
+}
+
+void GPUParticleSystem::Read(std::vector<GPUParticle>& out) const
+{
+	out.resize(m_Capacity);
+	const unsigned int size = m_Capacity * (unsigned int)sizeof(GPUParticle);
+	const unsigned int buffer = m_Buffers[m_Current]->GetRendererID();
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		glGetNamedBufferSubData(buffer, 0, size, out.data());
+	}
+	else
+	{
+		GLState::Get().BindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, size, out.data());
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include<vector>
+
+#include "CircleLOD.h"
+#include "ParticleSystem.h"
+
+class Shader;
+
+// One particle as GPUParticleSystem stores it
+struct GPUParticle
+{
+	float x, y;
+	float velocityX, velocityY;
+	// Negative until the particle's first birth, with a lifetime of 0
+	float age, lifetime;
+};
+
+// CPU reference for GPUParticleSystem: advances count particles by one update exactly as
+// its shaders do. step is the number of updates before this one.
+void StepGPUParticles(GPUParticle* particles, unsigned int count, const ParticleEmitter& emitter, float dt, unsigned int step, unsigned int seed);
+
+// Particles simulated and drawn without leaving the GPU. The pool has a fixed size:
+// particle i is born i / rate seconds after Reset() and is reborn at the emitter each time
+// its lifetime runs out, so capacity should be about rate times the average lifetime.
+// Update() runs ParticleUpdate.shader over one buffer with transform feedback into the
+// other and swaps them (GL 3.3); with compute shaders it runs ParticleSimulate.shader
+// between the same two buffers instead. Draw() instances the circle meshes straight from
+// the current buffer. Rebirths draw their random numbers from a hash of the particle index
+// and the step, not from a sequence, so particles are independent of each other and of
+// the path taken, and the result can be checked against StepGPUParticles.
+class GPUParticleSystem
+{
+private:
+	VertexBuffer* m_Buffers[2];
+	unsigned int m_Current;
+	// GPUParticle format for the transform feedback pass
+	VertexArray m_UpdateArray;
+	CircleLODMeshes m_Meshes;
+	// Transform feedback or compute
+	Shader* m_UpdateShader;
+	Shader* m_RenderShader;
+	bool m_Compute;
+	unsigned int m_Capacity;
+	unsigned int m_Step;
+	unsigned int m_Seed;
+	ParticleEmitter m_Emitter;
+
+public:
+	// Compute shaders are used when available, unless allowCompute is false
+	GPUParticleSystem(unsigned int capacity, unsigned int seed = 1, bool allowCompute = true);
+	~GPUParticleSystem();
+
+	GPUParticleSystem(const GPUParticleSystem&) = delete;
+	GPUParticleSystem& operator=(const GPUParticleSystem&) = delete;
+
+	inline ParticleEmitter& GetEmitter() { return m_Emitter; }
+	inline const ParticleEmitter& GetEmitter() const { return m_Emitter; }
+
+	// Empties the pool and staggers the births again by the emitter's current rate
+	void Reset();
+	void Update(float dt);
+	// Draws every live particle at the given level with ParticleRender.shader
+	void Draw(unsigned char level);
+
+	// Copies the particles back, waiting for the GPU; for debugging and validation
+	void Read(std::vector<GPUParticle>& out) const;
+
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+	inline unsigned int GetStep() const { return m_Step; }
+	inline bool IsComputePath() const { return m_Compute; }
+	// GPUParticle records, valid as vertex or instance data until the next Update()
+	inline const VertexBuffer& GetParticleBuffer() const { return *m_Buffers[m_Current]; }
+};
@@ -0,0 +1,22 @@
+#include "Geometry.h"
+#include "Tessellator.h"
+
+std::vector<float> GetPositions(float x, float y, float radius, unsigned int vertex_count)
+{
+    std::vector<float> positions(GetCircleVertexCount(vertex_count) * 2);
+    TessellateCircle(positions.data(), x, y, radius, vertex_count);
+    return positions;
+}
+
+unsigned int GetPositions(float* out, float x, float y, float radius, unsigned int vertex_count)
+{
+    TessellateCircle(out, x, y, radius, vertex_count);
+    return GetCircleVertexCount(vertex_count) * 2;
+}
+
+std::vector<unsigned int> GetIndices(unsigned int vertex_count, Topology topology)
+{
+    std::vector<unsigned int> indices(GetCircleIndexCount(topology, vertex_count));
+    GenerateCircleIndices(indices.data(), topology, vertex_count);
+    return indices;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include<vector>
+
+#include "IndexGenerator.h"
+
+// Circle as a fan: center plus vertex_count + 1 rim points (see Tessellator.h)
+std::vector<float> GetPositions(float x, float y, float radius, unsigned int vertex_count);
+// Writes the same fan straight into out (e.g. a mapped buffer); returns the number of floats written
+unsigned int GetPositions(float* out, float x, float y, float radius, unsigned int vertex_count);
+// Indices over the fan produced by GetPositions, drawn with GetTopologyMode(topology)
+std::vector<unsigned int> GetIndices(unsigned int vertex_count, Topology topology = Topology::TriangleFan);
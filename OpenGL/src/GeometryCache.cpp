@@ -0,0 +1,166 @@
+#include "GeometryCache.h"
+#include "Tessellator.h"
+
+#include<cmath>
+#include<vector>
+
+GeometryMesh::GeometryMesh(const float* positions, unsigned int vertexCount, const unsigned int* indexData, unsigned int indexCount, Topology topology)
+	: vertices(positions, vertexCount * 2 * sizeof(float)), indices(indexData, indexCount),
+	vertexCount(vertexCount), topology(topology),
+	bytes(vertexCount * 2 * sizeof(float) + indexCount * sizeof(unsigned int))
+{
+}
+
+GeometryCache::GeometryCache(size_t budgetBytes)
+	: m_Budget(budgetBytes)
+{
+}
+
+GeometryCache::QuantizedKey GeometryCache::Quantize(const GeometryKey& key)
+{
+	QuantizedKey quantized;
+	quantized.bits = ((uint64_t)key.kind << 40) | ((uint64_t)key.topology << 32) | key.segments;
+	for (unsigned int i = 0; i < 2; i++)
+		quantized.params[i] = key.kind == ShapeKind::Circle ? 0 : (int32_t)std::floor(key.params[i] * 4096.0f + 0.5f);
+	return quantized;
+}
+
+std::shared_ptr<const GeometryMesh> GeometryCache::Generate(const GeometryKey& key)
+{
+	// A strip skips the center vertex, which an arc's pie slice needs
+	Topology topology = key.kind == ShapeKind::Arc && key.topology == Topology::TriangleStrip ? Topology::TriangleFan : key.topology;
+
+	const unsigned int vertexCount = GetCircleVertexCount(key.segments);
+	std::vector<float> positions(vertexCount * 2);
+	switch (key.kind)
+	{
+	case ShapeKind::Circle:
+		TessellateCircle(positions.data(), 0.0f, 0.0f, 1.0f, key.segments);
+		break;
+	case ShapeKind::Ellipse:
+		TessellateEllipse(positions.data(), 0.0f, 0.0f, 1.0f, key.params[0], key.segments);
+		break;
+	case ShapeKind::Arc:
+		TessellateArc(positions.data(), 0.0f, 0.0f, 1.0f, key.params[0], key.params[1], key.segments);
+		break;
+	}
+
+	std::vector<unsigned int> indices(GetCircleIndexCount(topology, key.segments));
+	GenerateCircleIndices(indices.data(), topology, key.segments);
+
+	return std::make_shared<const GeometryMesh>(positions.data(), vertexCount, indices.data(), (unsigned int)indices.size(), topology);
+}
+
+std::shared_ptr<const GeometryMesh> GeometryCache::Get(const GeometryKey& key)
+{
+	QuantizedKey quantized = Quantize(key);
+
+	auto it = m_Entries.find(quantized);
+	if (it != m_Entries.end())
+	{
+		m_Stats.Hits++;
+		m_LRU.splice(m_LRU.begin(), m_LRU, it->second);
+		return it->second->mesh;
+	}
+
+	m_Stats.Misses++;
+
+	// Still on the GPU for some caller; take it back rather than upload it again
+	auto evicted = m_Evicted.find(quantized);
+	if (evicted != m_Evicted.end())
+	{
+		std::shared_ptr<const GeometryMesh> mesh = evicted->second.mesh.lock();
+		m_Stats.BytesUsed -= evicted->second.bytes;
+		m_Stats.EvictedBytes -= evicted->second.bytes;
+		m_Stats.EvictedInUse--;
+		m_Evicted.erase(evicted);
+		if (mesh)
+		{
+			m_Stats.Revivals++;
+			Insert(quantized, mesh);
+			return mesh;
+		}
+	}
+	PruneEvicted();
+
+	std::shared_ptr<const GeometryMesh> mesh = Generate(key);
+	Insert(quantized, mesh);
+	return mesh;
+}
+
+void GeometryCache::Insert(const QuantizedKey& key, const std::shared_ptr<const GeometryMesh>& mesh)
+{
+	Entry entry;
+	entry.key = key;
+	entry.mesh = mesh;
+
+	m_LRU.push_front(entry);
+	m_Entries[key] = m_LRU.begin();
+	m_Stats.BytesUsed += mesh->bytes;
+	m_Stats.ResidentBytes += mesh->bytes;
+	m_Stats.Entries++;
+
+	EvictToBudget();
+}
+
+void GeometryCache::SetBudget(size_t budgetBytes)
+{
+	m_Budget = budgetBytes;
+	EvictToBudget();
+}
+
+void GeometryCache::Clear()
+{
+	m_Entries.clear();
+	m_LRU.clear();
+	m_Evicted.clear();
+	m_Stats.BytesUsed = 0;
+	m_Stats.ResidentBytes = 0;
+	m_Stats.EvictedBytes = 0;
+	m_Stats.Entries = 0;
+	m_Stats.EvictedInUse = 0;
+}
+
+void GeometryCache::EvictToBudget()
+{
+	// Never evict the entry just added, even if it alone exceeds the budget. Only resident
+	// bytes count: evicting a mesh a caller still holds frees nothing, so counting it would
+	// empty the cache whenever held meshes alone exceed the budget.
+	while (m_Stats.ResidentBytes > m_Budget && m_LRU.size() > 1)
+	{
+		Entry& victim = m_LRU.back();
+		m_Stats.ResidentBytes -= victim.mesh->bytes;
+		m_Stats.Entries--;
+		m_Stats.Evictions++;
+		if (victim.mesh.use_count() > 1)
+		{
+			m_Evicted[victim.key] = EvictedEntry{ victim.mesh, victim.mesh->bytes };
+			m_Stats.EvictedBytes += victim.mesh->bytes;
+			m_Stats.EvictedInUse++;
+		}
+		else
+		{
+			m_Stats.BytesUsed -= victim.mesh->bytes;
+		}
+		m_Entries.erase(victim.key);
+		m_LRU.pop_back();
+	}
+}
+
+void GeometryCache::PruneEvicted()
+{
+	for (auto it = m_Evicted.begin(); it != m_Evicted.end();)
+	{
+		if (it->second.mesh.expired())
+		{
+			m_Stats.BytesUsed -= it->second.bytes;
+			m_Stats.EvictedBytes -= it->second.bytes;
+			m_Stats.EvictedInUse--;
+			it = m_Evicted.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
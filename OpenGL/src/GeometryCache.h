@@ -0,0 +1,121 @@
+#pragma once
+
+#include<cstdint>
+#include<list>
+#include<memory>
+#include<unordered_map>
+
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "IndexGenerator.h"
+#include "Tessellator.h"
+
+// Shape in unit space: centered on the origin with an x radius of 1. Position and size
+// are applied when drawing, so every circle with the same segment count shares one mesh.
+struct GeometryKey
+{
+	ShapeKind kind = ShapeKind::Circle;
+	Topology topology = Topology::TriangleFan;
+	unsigned int segments = 32;
+	// Ellipse: y radius / x radius. Arc: start and end angle in radians.
+	// Quantized to 1/4096 when looked up, so near-identical shapes share a mesh.
+	float params[2] = { 0.0f, 0.0f };
+};
+
+struct GeometryMesh
+{
+	VertexBuffer vertices;
+	IndexBuffer indices;
+	unsigned int vertexCount;
+	Topology topology;
+	size_t bytes;
+
+	GeometryMesh(const float* positions, unsigned int vertexCount, const unsigned int* indexData, unsigned int indexCount, Topology topology);
+};
+
+struct GeometryCacheStats
+{
+	unsigned int Hits = 0;
+	unsigned int Misses = 0;
+	unsigned int Evictions = 0;
+	// Misses served by an evicted mesh that a caller still held
+	unsigned int Revivals = 0;
+	// Every live mesh the cache made: ResidentBytes plus EvictedBytes
+	size_t BytesUsed = 0;
+	// The cache's own entries; only these count against the budget
+	size_t ResidentBytes = 0;
+	// Evicted meshes still held by callers as of the last miss
+	size_t EvictedBytes = 0;
+	unsigned int Entries = 0;
+	unsigned int EvictedInUse = 0;
+};
+
+// Generates and uploads each distinct shape once. Meshes are handed out as shared
+// pointers; when the cache exceeds its byte budget the least recently used entries are
+// dropped, and their GPU buffers are freed once the last user lets go. Until then the
+// cache keeps a weak reference, so asking for the shape again reuses the same buffers
+// instead of uploading a second copy, and the bytes still count towards BytesUsed.
+class GeometryCache
+{
+private:
+	struct QuantizedKey
+	{
+		uint64_t bits;
+		int32_t params[2];
+
+		bool operator==(const QuantizedKey& other) const
+		{
+			return bits == other.bits && params[0] == other.params[0] && params[1] == other.params[1];
+		}
+	};
+
+	struct QuantizedKeyHash
+	{
+		size_t operator()(const QuantizedKey& key) const
+		{
+			uint64_t h = key.bits * 0x9E3779B97F4A7C15ull;
+			h ^= (uint32_t)key.params[0] + 0x7F4A7C15ull + (h << 6) + (h >> 2);
+			h ^= (uint32_t)key.params[1] + 0x7F4A7C15ull + (h << 6) + (h >> 2);
+			return (size_t)h;
+		}
+	};
+
+	struct Entry
+	{
+		QuantizedKey key;
+		std::shared_ptr<const GeometryMesh> mesh;
+	};
+
+	struct EvictedEntry
+	{
+		std::weak_ptr<const GeometryMesh> mesh;
+		// Kept here since an expired mesh can no longer be asked
+		size_t bytes;
+	};
+
+	// Front is most recently used
+	std::list<Entry> m_LRU;
+	std::unordered_map<QuantizedKey, std::list<Entry>::iterator, QuantizedKeyHash> m_Entries;
+	std::unordered_map<QuantizedKey, EvictedEntry, QuantizedKeyHash> m_Evicted;
+	size_t m_Budget;
+	GeometryCacheStats m_Stats;
+
+public:
+	explicit GeometryCache(size_t budgetBytes = 16 * 1024 * 1024);
+
+	std::shared_ptr<const GeometryMesh> Get(const GeometryKey& key);
+
+	void SetBudget(size_t budgetBytes);
+	void Clear();
+
+	inline const GeometryCacheStats& GetStats() const { return m_Stats; }
+	inline void ResetCounters() { m_Stats.Hits = m_Stats.Misses = m_Stats.Evictions = 0; }
+
+private:
+	static QuantizedKey Quantize(const GeometryKey& key);
+	static std::shared_ptr<const GeometryMesh> Generate(const GeometryKey& key);
+	void Insert(const QuantizedKey& key, const std::shared_ptr<const GeometryMesh>& mesh);
+	void EvictToBudget();
+	// Drops evicted meshes that no caller holds any more
+	void PruneEvicted();
+};
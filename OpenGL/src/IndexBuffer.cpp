@@ -1,28 +1,39 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "GLState.h"
 
 IndexBuffer::IndexBuffer(const void* data, unsigned int count)
     : m_Count(count)
 {
     ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
-    glGenBuffers(1, &m_RendererID);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW);
+    if (GLGetCapabilities().DirectStateAccess)
+    {
+        glCreateBuffers(1, &m_RendererID);
+        glNamedBufferData(m_RendererID, count * sizeof(unsigned int), data, GL_STATIC_DRAW);
+    }
+    else
+    {
+        // Upload through GL_ARRAY_BUFFER: binding GL_ELEMENT_ARRAY_BUFFER would
+        // attach this buffer to whatever vertex array happens to be bound.
+        glGenBuffers(1, &m_RendererID);
+        GLState::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW);
+    }
 }
 
 IndexBuffer::~IndexBuffer()
 {
-
+    GLState::Get().OnBufferDeleted(m_RendererID);
     glDeleteBuffers(1, &m_RendererID);
 }
 
 void IndexBuffer::Bind() const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    GLState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
 }
 
 void IndexBuffer::Unbind() const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
@@ -0,0 +1,90 @@
+#include "IndexGenerator.h"
+#include "Renderer.h"
+
+unsigned int GetTopologyMode(Topology topology)
+{
+	switch (topology)
+	{
+	case Topology::TriangleList:
+		return GL_TRIANGLES;
+	case Topology::TriangleFan:
+		return GL_TRIANGLE_FAN;
+	case Topology::TriangleStrip:
+		return GL_TRIANGLE_STRIP;
+	}
+	ASSERT(false);
+	return GL_TRIANGLES;
+}
+
+unsigned int GetCircleIndexCount(Topology topology, unsigned int segments)
+{
+	switch (topology)
+	{
+	case Topology::TriangleList:
+		return 3 * segments;
+	case Topology::TriangleFan:
+		return segments + 2;
+	case Topology::TriangleStrip:
+		return segments;
+	}
+	ASSERT(false);
+	return 0;
+}
+
+unsigned int GenerateCircleIndices(unsigned int* out, Topology topology, unsigned int segments, unsigned int baseVertex)
+{
+	unsigned int n = 0;
+	switch (topology)
+	{
+	case Topology::TriangleList:
+		for (unsigned int i = 1; i <= segments; i++)
+		{
+			out[n++] = baseVertex;
+			out[n++] = baseVertex + i;
+			out[n++] = baseVertex + i + 1;
+		}
+		break;
+	case Topology::TriangleFan:
+		for (unsigned int i = 0; i < segments + 2; i++)
+			out[n++] = baseVertex + i;
+		break;
+	case Topology::TriangleStrip:
+	{
+		// Rim points are 1..segments; alternate between both ends so every triangle spans the polygon
+		unsigned int low = 1, high = segments;
+		while (low <= high)
+		{
+			out[n++] = baseVertex + low++;
+			if (low <= high)
+				out[n++] = baseVertex + high--;
+		}
+		break;
+	}
+	}
+	return n;
+}
+
+IndexBatch::IndexBatch(Topology topology)
+	: m_Topology(topology), m_VertexCount(0), m_ShapeCount(0)
+{
+}
+
+void IndexBatch::Clear()
+{
+	m_Indices.clear();
+	m_VertexCount = 0;
+	m_ShapeCount = 0;
+}
+
+void IndexBatch::AddCircle(unsigned int segments)
+{
+	if (m_ShapeCount > 0 && NeedsPrimitiveRestart())
+		m_Indices.push_back(PRIMITIVE_RESTART_INDEX);
+
+	size_t first = m_Indices.size();
+	m_Indices.resize(first + GetCircleIndexCount(m_Topology, segments));
+	GenerateCircleIndices(&m_Indices[first], m_Topology, segments, m_VertexCount);
+
+	m_VertexCount += segments + 2;
+	m_ShapeCount++;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include<vector>
+
+enum class Topology
+{
+	TriangleList, TriangleFan, TriangleStrip
+};
+
+// Separates primitives in a batched index buffer; the largest GLuint, so the same value
+// works with fixed-index restart (GL 4.3) and glPrimitiveRestartIndex (GL 3.1)
+const unsigned int PRIMITIVE_RESTART_INDEX = 0xFFFFFFFF;
+
+unsigned int GetTopologyMode(Topology topology);
+
+// Indices for one circle laid out as by Tessellator: center, then segments + 1 rim points.
+//   list:  3 * segments   (0, i, i + 1)
+//   fan:   segments + 2   (0, 1, ..., segments + 1)
+//   strip: segments       rim points zig-zagged across the polygon, no center needed
+unsigned int GetCircleIndexCount(Topology topology, unsigned int segments);
+// Writes GetCircleIndexCount() indices offset by baseVertex, returns the number written
+unsigned int GenerateCircleIndices(unsigned int* out, Topology topology, unsigned int segments, unsigned int baseVertex = 0);
+
+// Concatenates many shapes into one index buffer. Fans and strips are separated by
+// PRIMITIVE_RESTART_INDEX so the whole batch draws in one call with restart enabled.
+class IndexBatch
+{
+private:
+	std::vector<unsigned int> m_Indices;
+	Topology m_Topology;
+	unsigned int m_VertexCount;
+	unsigned int m_ShapeCount;
+
+public:
+	explicit IndexBatch(Topology topology);
+
+	void Clear();
+	// Indexes the next segments + 2 vertices appended to the matching vertex buffer
+	void AddCircle(unsigned int segments);
+
+	inline const std::vector<unsigned int>& GetIndices() const { return m_Indices; }
+	inline Topology GetTopology() const { return m_Topology; }
+	inline unsigned int GetVertexCount() const { return m_VertexCount; }
+	inline bool NeedsPrimitiveRestart() const { return m_Topology != Topology::TriangleList; }
+};
@@ -0,0 +1,105 @@
+#include "IndirectDrawBuilder.h"
+#include "GLState.h"
+#include "Renderer.h"
+
+IndirectDrawBuilder::IndirectDrawBuilder(VertexArray& va, unsigned int firstAttrib)
+	: m_IndirectBuffer(0), m_DrawDataBuffer(nullptr, 0), m_Dirty(true)
+{
+	if (GLGetCapabilities().MultiDrawIndirect)
+	{
+		if (GLGetCapabilities().DirectStateAccess)
+			glCreateBuffers(1, &m_IndirectBuffer);
+		else
+			glGenBuffers(1, &m_IndirectBuffer);
+	}
+
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	layout.Push<float>(4);
+	va.AddInstanceBuffer(m_DrawDataBuffer, layout, firstAttrib);
+}
+
+IndirectDrawBuilder::~IndirectDrawBuilder()
+{
+	if (m_IndirectBuffer)
+	{
+		GLState::Get().OnBufferDeleted(m_IndirectBuffer);
+		glDeleteBuffers(1, &m_IndirectBuffer);
+	}
+}
+
+void IndirectDrawBuilder::Clear()
+{
+	m_Commands.clear();
+	m_DrawData.clear();
+	m_Dirty = true;
+}
+
+void IndirectDrawBuilder::Add(unsigned int indexCount, unsigned int firstIndex, int baseVertex, float offsetX, float offsetY, const float color[4])
+{
+	DrawElementsIndirectCommand command;
+	command.count = indexCount;
+	command.instanceCount = 1;
+	command.firstIndex = firstIndex;
+	command.baseVertex = baseVertex;
+	command.baseInstance = (unsigned int)m_Commands.size();
+	m_Commands.push_back(command);
+
+	PerDrawData data;
+	data.offset[0] = offsetX;
+	data.offset[1] = offsetY;
+	for (unsigned int i = 0; i < 4; i++)
+		data.color[i] = color[i];
+	m_DrawData.push_back(data);
+
+	m_Dirty = true;
+}
+
+void IndirectDrawBuilder::Draw(const VertexArray& va, const IndexBuffer& ib, unsigned int mode)
+{
+	if (m_Commands.empty())
+		return;
+
+	const bool multiDraw = GLGetCapabilities().MultiDrawIndirect;
+	GLState& state = GLState::Get();
+
+	if (m_Dirty)
+	{
+		m_DrawDataBuffer.SetData(m_DrawData.data(), (unsigned int)(m_DrawData.size() * sizeof(PerDrawData)));
+
+		if (multiDraw)
+		{
+			const GLsizeiptr size = m_Commands.size() * sizeof(DrawElementsIndirectCommand);
+			if (GLGetCapabilities().DirectStateAccess)
+			{
+				glNamedBufferData(m_IndirectBuffer, size, m_Commands.data(), GL_DYNAMIC_DRAW);
+			}
+			else
+			{
+				state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+				glBufferData(GL_DRAW_INDIRECT_BUFFER, size, m_Commands.data(), GL_DYNAMIC_DRAW);
+			}
+		}
+		m_Dirty = false;
+	}
+
+	va.Bind();
+	ib.Bind();
+
+	if (multiDraw)
+	{
+		state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+		glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, nullptr, (GLsizei)m_Commands.size(), 0);
+		return;
+	}
+
+	// No base instance before GL 4.2, so move the per-draw attributes to each record instead
+	for (unsigned int i = 0; i < m_Commands.size(); i++)
+	{
+		const DrawElementsIndirectCommand& command = m_Commands[i];
+		va.BindInstanceBuffer(m_DrawDataBuffer, i * sizeof(PerDrawData));
+		glDrawElementsBaseVertex(mode, command.count, GL_UNSIGNED_INT,
+			(void*)(uintptr_t)(command.firstIndex * sizeof(unsigned int)), command.baseVertex);
+	}
+	va.BindInstanceBuffer(m_DrawDataBuffer, 0);
+}
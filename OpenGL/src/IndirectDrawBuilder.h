@@ -0,0 +1,50 @@
+#pragma once
+
+#include<vector>
+
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+
+// Layout fixed by GL for glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+	unsigned int count;
+	unsigned int instanceCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int baseInstance;
+};
+
+// Per-object data that replaces the u_Offset/u_Color uniforms, read by Batch.shader
+struct PerDrawData
+{
+	float offset[2];
+	float color[4];
+};
+
+// Collects many meshes that live in one shared vertex/index buffer and submits them
+// with a single glMultiDrawElementsIndirect. Each command's baseInstance is its draw
+// index, which selects its PerDrawData through instanced attributes. Contexts without
+// multi-draw indirect fall back to a loop of glDrawElementsBaseVertex.
+class IndirectDrawBuilder
+{
+private:
+	std::vector<DrawElementsIndirectCommand> m_Commands;
+	std::vector<PerDrawData> m_DrawData;
+	unsigned int m_IndirectBuffer;
+	VertexBuffer m_DrawDataBuffer;
+	bool m_Dirty;
+
+public:
+	// Attaches the per-draw data to va at locations firstAttrib (offset) and firstAttrib + 1 (color)
+	IndirectDrawBuilder(VertexArray& va, unsigned int firstAttrib);
+	~IndirectDrawBuilder();
+
+	void Clear();
+	void Add(unsigned int indexCount, unsigned int firstIndex, int baseVertex, float offsetX, float offsetY, const float color[4]);
+
+	// Uploads the recorded commands if they changed, then issues every draw. The shader must be bound.
+	void Draw(const VertexArray& va, const IndexBuffer& ib, unsigned int mode);
+
+	inline unsigned int GetDrawCount() const { return (unsigned int)m_Commands.size(); }
+};
@@ -0,0 +1,354 @@
+#include "JobSystem.h"
+
+#include<cstdint>
+
+struct Job
+{
+	std::function<void()> function;
+	JobCounter* counter;
+};
+
+// Fixed-size Chase-Lev deque (Le et al., "Correct and Efficient Work-Stealing for
+// Weak Memory Models"). Push and Pop are owner-only; Steal may be called from any thread.
+class WorkStealingQueue
+{
+private:
+	static const int64_t Capacity = 4096;
+
+	std::atomic<int64_t> m_Top;
+	// Keep the thieves' end and the owner's end on separate cache lines
+	char m_Padding[64];
+	std::atomic<int64_t> m_Bottom;
+	std::atomic<Job*> m_Buffer[Capacity];
+
+public:
+	WorkStealingQueue()
+		: m_Top(0), m_Bottom(0)
+	{
+	}
+
+	// False when full; the caller runs the job itself
+	bool Push(Job* job)
+	{
+		int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+		int64_t top = m_Top.load(std::memory_order_acquire);
+		if (bottom - top >= Capacity)
+			return false;
+
+		m_Buffer[bottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+		m_Bottom.store(bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	Job* Pop()
+	{
+		int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		m_Bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = m_Top.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job* job = m_Buffer[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			// Last job: race the thieves for it
+			if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				job = nullptr;
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	// Sets contended when another thread won the race, so the deque may still hold work
+	Job* Steal(bool& contended)
+	{
+		int64_t top = m_Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+		if (top >= bottom)
+			return nullptr;
+
+		Job* job = m_Buffer[top & (Capacity - 1)].load(std::memory_order_relaxed);
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			contended = true;
+			return nullptr;
+		}
+		return job;
+	}
+};
+
+static thread_local const JobSystem* s_System = nullptr;
+static thread_local int s_QueueIndex = -1;
+static thread_local unsigned int s_Random = 0x9E3779B9u;
+
+JobCounter::JobCounter()
+	: m_Value(0), m_Finishing(0)
+{
+}
+
+JobCounter::~JobCounter()
+{
+}
+
+JobSystem::JobSystem(unsigned int workerCount)
+	: m_MainThread(std::this_thread::get_id()), m_InjectedCount(0), m_WorkEpoch(0), m_Sleeping(0), m_Quit(false)
+{
+	if (workerCount == HardwareWorkers)
+	{
+		unsigned int hardware = std::thread::hardware_concurrency();
+		workerCount = hardware > 1 ? hardware - 1 : 0;
+	}
+
+	for (unsigned int i = 0; i < workerCount + 1; i++)
+		m_Queues.emplace_back(new WorkStealingQueue());
+
+	for (unsigned int i = 0; i < workerCount; i++)
+		m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Quit = true;
+	}
+	m_WorkReady.notify_all();
+
+	for (auto& worker : m_Workers)
+		worker.join();
+}
+
+void JobSystem::Run(std::function<void()> job, JobCounter* counter, JobCounter* dependency)
+{
+	Job* entry = new Job{ std::move(job), counter };
+	if (counter)
+		counter->m_Value++;
+
+	if (dependency)
+	{
+		std::lock_guard<std::mutex> lock(dependency->m_Mutex);
+		if (dependency->m_Value.load() != 0)
+		{
+			dependency->m_Continuations.push_back(entry);
+			return;
+		}
+	}
+
+	Push(entry);
+}
+
+void JobSystem::RunOnMainThread(std::function<void()> job, JobCounter* counter)
+{
+	Job* entry = new Job{ std::move(job), counter };
+	if (counter)
+		counter->m_Value++;
+
+	std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+	m_MainThreadJobs.push_back(entry);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	const int queueIndex = GetQueueIndex();
+	while (!counter.IsDone())
+	{
+		if (Job* job = FindJob(queueIndex))
+			Execute(job);
+		else if (!(queueIndex == 0 && RunMainThreadJobs()))
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::PumpMainThread()
+{
+	RunMainThreadJobs();
+}
+
+static void RunChunks(JobSystem& jobs, JobCounter& counter, const std::function<void(unsigned int, unsigned int)>& body,
+	unsigned int count, unsigned int chunkSize, unsigned int first, unsigned int last)
+{
+	// Hand the upper half to the deque and keep going with the lower one; thieves
+	// take from the top, so they get the largest ranges left
+	while (last - first > 1)
+	{
+		unsigned int middle = first + (last - first) / 2;
+		jobs.Run([&jobs, &counter, &body, count, chunkSize, middle, last]
+		{
+			RunChunks(jobs, counter, body, count, chunkSize, middle, last);
+		}, &counter);
+		last = middle;
+	}
+
+	unsigned int begin = first * chunkSize;
+	body(begin, count - begin > chunkSize ? begin + chunkSize : count);
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int chunkSize, const std::function<void(unsigned int begin, unsigned int end)>& body)
+{
+	if (count == 0)
+		return;
+	if (chunkSize == 0)
+	{
+		chunkSize = count / (GetThreadCount() * 4);
+		if (chunkSize == 0)
+			chunkSize = 1;
+	}
+
+	const unsigned int chunks = (count - 1) / chunkSize + 1;
+	if (chunks == 1 || m_Workers.empty())
+	{
+		for (unsigned int begin = 0; begin < count; begin += chunkSize)
+			body(begin, count - begin > chunkSize ? begin + chunkSize : count);
+		return;
+	}
+
+	JobCounter counter;
+	RunChunks(*this, counter, body, count, chunkSize, 0, chunks);
+	Wait(counter);
+}
+
+void JobSystem::WorkerLoop(unsigned int queueIndex)
+{
+	s_System = this;
+	s_QueueIndex = (int)queueIndex;
+	s_Random ^= queueIndex * 0x85EBCA6Bu;
+
+	for (;;)
+	{
+		unsigned int epoch = m_WorkEpoch.load();
+		if (Job* job = FindJob((int)queueIndex))
+		{
+			Execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_Sleeping++;
+		m_WorkReady.wait(lock, [&] { return m_Quit || m_WorkEpoch.load() != epoch; });
+		m_Sleeping--;
+		if (m_Quit)
+			return;
+	}
+}
+
+int JobSystem::GetQueueIndex() const
+{
+	if (s_System == this)
+		return s_QueueIndex;
+	return std::this_thread::get_id() == m_MainThread ? 0 : -1;
+}
+
+void JobSystem::Push(Job* job)
+{
+	const int queueIndex = GetQueueIndex();
+	if (queueIndex < 0)
+	{
+		std::lock_guard<std::mutex> lock(m_InjectMutex);
+		m_Injected.push_back(job);
+		m_InjectedCount++;
+	}
+	else if (!m_Queues[queueIndex]->Push(job))
+	{
+		Execute(job);
+		return;
+	}
+
+	Wake();
+}
+
+Job* JobSystem::FindJob(int queueIndex)
+{
+	if (queueIndex >= 0)
+	{
+		if (Job* job = m_Queues[queueIndex]->Pop())
+			return job;
+	}
+
+	if (m_InjectedCount.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_InjectMutex);
+		if (!m_Injected.empty())
+		{
+			Job* job = m_Injected.back();
+			m_Injected.pop_back();
+			m_InjectedCount--;
+			return job;
+		}
+	}
+
+	// Start at a random victim so thieves spread out instead of all hitting queue 0
+	const unsigned int queueCount = (unsigned int)m_Queues.size();
+	bool contended;
+	do
+	{
+		contended = false;
+		s_Random ^= s_Random << 13;
+		s_Random ^= s_Random >> 17;
+		s_Random ^= s_Random << 5;
+
+		for (unsigned int i = 0, victim = s_Random % queueCount; i < queueCount; i++, victim = victim + 1 == queueCount ? 0 : victim + 1)
+		{
+			if ((int)victim == queueIndex)
+				continue;
+			if (Job* job = m_Queues[victim]->Steal(contended))
+				return job;
+		}
+	} while (contended);
+
+	return nullptr;
+}
+
+void JobSystem::Execute(Job* job)
+{
+	job->function();
+
+	JobCounter* counter = job->counter;
+	delete job;
+	if (counter)
+		Finish(*counter);
+}
+
+void JobSystem::Finish(JobCounter& counter)
+{
+	counter.m_Finishing++;
+	if (counter.m_Value.fetch_sub(1) == 1)
+	{
+		std::vector<Job*> ready;
+		{
+			std::lock_guard<std::mutex> lock(counter.m_Mutex);
+			ready.swap(counter.m_Continuations);
+		}
+		for (Job* job : ready)
+			Push(job);
+	}
+	counter.m_Finishing--;
+}
+
+bool JobSystem::RunMainThreadJobs()
+{
+	std::vector<Job*> jobs;
+	{
+		std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+		jobs.swap(m_MainThreadJobs);
+	}
+
+	for (Job* job : jobs)
+		Execute(job);
+	return !jobs.empty();
+}
+
+void JobSystem::Wake()
+{
+	m_WorkEpoch++;
+	if (m_Sleeping.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_WorkReady.notify_one();
+	}
+}
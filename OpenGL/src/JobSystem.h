@@ -0,0 +1,104 @@
+#pragma once
+
+#include<atomic>
+#include<condition_variable>
+#include<functional>
+#include<memory>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+struct Job;
+class WorkStealingQueue;
+
+// Counts unfinished jobs. Run() increments it, finishing a job decrements it; jobs
+// that depend on a counter are held back until it reaches zero.
+class JobCounter
+{
+private:
+	std::atomic<unsigned int> m_Value;
+	// Threads still inside Finish(), so Wait() can't return while one is touching the counter
+	std::atomic<unsigned int> m_Finishing;
+	std::mutex m_Mutex;
+	std::vector<Job*> m_Continuations;
+
+	friend class JobSystem;
+
+public:
+	JobCounter();
+	~JobCounter();
+
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	inline bool IsDone() const { return m_Value.load() == 0 && m_Finishing.load() == 0; }
+};
+
+// Persistent workers, each with its own Chase-Lev deque: a worker pushes and pops
+// at the bottom of its deque, idle workers steal from the top of the others'.
+// The constructing thread is the main thread and owns a deque as well. Threads that
+// wait on a counter run jobs meanwhile instead of blocking, so there is never more
+// than one busy thread per hardware thread however deeply jobs nest.
+class JobSystem
+{
+private:
+	std::vector<std::thread> m_Workers;
+	// [0] belongs to the main thread, [i + 1] to worker i
+	std::vector<std::unique_ptr<WorkStealingQueue>> m_Queues;
+	std::thread::id m_MainThread;
+
+	// Jobs submitted from threads that don't own a deque
+	std::mutex m_InjectMutex;
+	std::vector<Job*> m_Injected;
+	std::atomic<unsigned int> m_InjectedCount;
+
+	// GL work that has to run on the main thread, see PumpMainThread()
+	std::mutex m_MainThreadMutex;
+	std::vector<Job*> m_MainThreadJobs;
+
+	// Idle workers sleep until the epoch moves past the one they last searched in
+	std::mutex m_SleepMutex;
+	std::condition_variable m_WorkReady;
+	std::atomic<unsigned int> m_WorkEpoch;
+	std::atomic<unsigned int> m_Sleeping;
+	bool m_Quit;
+
+public:
+	static const unsigned int HardwareWorkers = 0xFFFFFFFF;
+
+	// HardwareWorkers = one per hardware thread, minus the calling thread. With 0 workers
+	// every job runs on the threads that wait for it, e.g. as a single-threaded reference.
+	explicit JobSystem(unsigned int workerCount = HardwareWorkers);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Schedules job on any thread. counter (optional) is incremented now and decremented
+	// once job has run; job doesn't start until dependency (optional) is done.
+	void Run(std::function<void()> job, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+	// Queues job for the next PumpMainThread(); for work that needs the GL context
+	void RunOnMainThread(std::function<void()> job, JobCounter* counter = nullptr);
+	// Runs jobs until counter is done. On the main thread this includes main-thread jobs.
+	void Wait(JobCounter& counter);
+	// Runs everything queued with RunOnMainThread(); call once per frame from the main thread
+	void PumpMainThread();
+
+	// Calls body(begin, end) once per chunk of [0, count) and waits for all of them.
+	// chunkSize 0 picks one giving a few chunks per thread. Chunks are split off
+	// recursively, so stealing spreads a large range in a few steps.
+	void ParallelFor(unsigned int count, unsigned int chunkSize, const std::function<void(unsigned int begin, unsigned int end)>& body);
+
+	inline unsigned int GetThreadCount() const { return (unsigned int)m_Workers.size() + 1; }
+
+private:
+	void WorkerLoop(unsigned int queueIndex);
+	// Deque owned by the calling thread, or -1 for threads outside the system
+	int GetQueueIndex() const;
+	void Push(Job* job);
+	Job* FindJob(int queueIndex);
+	void Execute(Job* job);
+	void Finish(JobCounter& counter);
+	bool RunMainThreadJobs();
+	void Wake();
+};
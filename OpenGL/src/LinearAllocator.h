@@ -0,0 +1,44 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+
+// Bump allocator for per-frame data. Reset() releases everything at once;
+// nothing is freed individually and no destructors run.
+class LinearAllocator
+{
+private:
+	unsigned char* m_Buffer;
+	size_t m_Capacity;
+	size_t m_Offset;
+
+public:
+	explicit LinearAllocator(size_t capacity)
+		: m_Buffer(new unsigned char[capacity]), m_Capacity(capacity), m_Offset(0) {}
+	~LinearAllocator() { delete[] m_Buffer; }
+
+	LinearAllocator(const LinearAllocator&) = delete;
+	LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+	// Returns nullptr once the frame's budget is used up
+	void* Allocate(size_t size, size_t alignment)
+	{
+		uintptr_t base = (uintptr_t)m_Buffer;
+		uintptr_t aligned = (base + m_Offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		size_t offset = aligned - base;
+		if (offset + size > m_Capacity)
+			return nullptr;
+		m_Offset = offset + size;
+		return (void*)aligned;
+	}
+
+	template<typename T>
+	T* Allocate(size_t count = 1)
+	{
+		return (T*)Allocate(sizeof(T) * count, alignof(T));
+	}
+
+	inline void Reset() { m_Offset = 0; }
+	inline size_t GetUsed() const { return m_Offset; }
+	inline size_t GetCapacity() const { return m_Capacity; }
+};
@@ -0,0 +1,166 @@
+#include "Math2D.h"
+#include "SimdFloats.h"
+
+// Cephes-style sinf/cosf: reduce to [-pi/4, pi/4] around the nearest multiple of pi/2,
+// evaluate both polynomials and pick and sign them by octant
+static inline void SinCos(Floats angle, Floats& sine, Floats& cosine)
+{
+	const Floats zero = Set(0.0f);
+	Floats x = Abs(angle);
+
+	// Even octant index j, so x - j * pi/4 lands in [-pi/4, pi/4]
+	Floats j = Truncate(Mul(x, Set(1.27323954473516f)));
+	j = Mul(Truncate(Mul(Add(j, Set(1.0f)), Set(0.5f))), Set(2.0f));
+
+	// Extended precision pi/4 keeps the reduction accurate for large angles
+	x = Sub(x, Mul(j, Set(0.78515625f)));
+	x = Sub(x, Mul(j, Set(2.4187564849853515625e-4f)));
+	x = Sub(x, Mul(j, Set(3.77489497744594108e-8f)));
+
+	Floats z = Mul(x, x);
+	Floats s = Add(Mul(Set(-1.9515295891e-4f), z), Set(8.3321608736e-3f));
+	s = Add(Mul(s, z), Set(-1.6666654611e-1f));
+	s = Add(Mul(Mul(s, z), x), x);
+	Floats c = Add(Mul(Set(2.443315711809948e-5f), z), Set(-1.388731625493765e-3f));
+	c = Add(Mul(c, z), Set(4.166664568298827e-2f));
+	c = Add(Sub(Mul(Mul(c, z), z), Mul(z, Set(0.5f))), Set(1.0f));
+
+	// j mod 8: 0 -> (s, c), 2 -> (c, -s), 4 -> (-s, -c), 6 -> (-c, s)
+	Floats octant = Sub(j, Mul(Truncate(Mul(j, Set(0.125f))), Set(8.0f)));
+	Mask swap = Or(Equal(octant, Set(2.0f)), Equal(octant, Set(6.0f)));
+	Mask negateSine = Xor(GreaterEqual(octant, Set(4.0f)), Less(angle, zero));
+	Mask negateCosine = Or(Equal(octant, Set(2.0f)), Equal(octant, Set(4.0f)));
+
+	sine = Select(swap, c, s);
+	cosine = Select(swap, s, c);
+	sine = Select(negateSine, Sub(zero, sine), sine);
+	cosine = Select(negateCosine, Sub(zero, cosine), cosine);
+}
+
+void TransformPoints(const Mat3& transform, const Vec2* in, Vec2* out, unsigned int count)
+{
+	const float* m = transform.m;
+	const float* src = &in->x;
+	float* dst = &out->x;
+	unsigned int i = 0;
+
+#if defined(SIMD_SSE) || defined(SIMD_NEON)
+	// WIDTH / 2 points per register: x' = a x + c y + tx and y' = b x + d y + ty at once
+	const Floats ab = SetPairs(m[0], m[1]), cd = SetPairs(m[3], m[4]), t = SetPairs(m[6], m[7]);
+	for (; 2 * i + WIDTH <= 2 * count; i += WIDTH / 2)
+	{
+		Floats xy = Load(src + 2 * i);
+		Store(dst + 2 * i, Add(Add(Mul(DuplicateEven(xy), ab), Mul(DuplicateOdd(xy), cd)), t));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		float x = src[2 * i], y = src[2 * i + 1];
+		dst[2 * i] = m[0] * x + m[3] * y + m[6];
+		dst[2 * i + 1] = m[1] * x + m[4] * y + m[7];
+	}
+}
+
+void TransformPoints(const Mat3& transform, const float* xIn, const float* yIn, float* xOut, float* yOut, unsigned int count)
+{
+	const float* m = transform.m;
+	const Floats a = Set(m[0]), b = Set(m[1]), c = Set(m[3]), d = Set(m[4]), tx = Set(m[6]), ty = Set(m[7]);
+
+	unsigned int i = 0;
+	for (; i + WIDTH <= count; i += WIDTH)
+	{
+		Floats x = Load(xIn + i), y = Load(yIn + i);
+		Store(xOut + i, Add(Add(Mul(a, x), Mul(c, y)), tx));
+		Store(yOut + i, Add(Add(Mul(b, x), Mul(d, y)), ty));
+	}
+
+	for (; i < count; i++)
+	{
+		float x = xIn[i], y = yIn[i];
+		xOut[i] = m[0] * x + m[3] * y + m[6];
+		yOut[i] = m[1] * x + m[4] * y + m[7];
+	}
+}
+
+void SinCos(const float* angles, float* sines, float* cosines, unsigned int count)
+{
+#if !defined(SIMD_SSE) && !defined(SIMD_NEON)
+	// Without vectors the library versions are faster than the branchy polynomial
+	for (unsigned int i = 0; i < count; i++)
+	{
+		sines[i] = std::sin(angles[i]);
+		cosines[i] = std::cos(angles[i]);
+	}
+#else
+	unsigned int i = 0;
+	for (; i + WIDTH <= count; i += WIDTH)
+	{
+		Floats s, c;
+		SinCos(Load(angles + i), s, c);
+		Store(sines + i, s);
+		Store(cosines + i, c);
+	}
+
+	// Same polynomial for the tail, so results don't depend on the position in the array
+	if (i < count)
+	{
+		float a[WIDTH] = {}, s[WIDTH], c[WIDTH];
+		for (unsigned int k = 0; k < count - i; k++)
+			a[k] = angles[i + k];
+		Floats vs, vc;
+		SinCos(Load(a), vs, vc);
+		Store(s, vs);
+		Store(c, vc);
+		for (unsigned int k = 0; k < count - i; k++)
+		{
+			sines[i + k] = s[k];
+			cosines[i + k] = c[k];
+		}
+	}
+#endif
+}
+
+void BuildTRS(const float* x, const float* y, const float* rotation, const float* scaleX, const float* scaleY, Mat3* out, unsigned int count)
+{
+#if !defined(SIMD_SSE) && !defined(SIMD_NEON)
+	for (unsigned int i = 0; i < count; i++)
+		out[i] = Mat3::TRS(x[i], y[i], rotation[i], scaleX[i], scaleY[i]);
+#else
+	// Transcendentals in bulk, then a scalar pass to scatter into the 3x3 layout
+	const unsigned int BATCH = 256;
+	float sines[BATCH], cosines[BATCH];
+
+	for (unsigned int first = 0; first < count; first += BATCH)
+	{
+		unsigned int n = count - first < BATCH ? count - first : BATCH;
+		SinCos(rotation + first, sines, cosines, n);
+
+		for (unsigned int k = 0; k < n; k++)
+		{
+			const unsigned int i = first + k;
+			float* m = out[i].m;
+			m[0] = cosines[k] * scaleX[i];
+			m[1] = sines[k] * scaleX[i];
+			m[2] = 0.0f;
+			m[3] = -sines[k] * scaleY[i];
+			m[4] = cosines[k] * scaleY[i];
+			m[5] = 0.0f;
+			m[6] = x[i];
+			m[7] = y[i];
+			m[8] = 1.0f;
+		}
+	}
+#endif
+}
+
+void EvaluateGradient(const Vec4& from, const Vec4& to, const float* t, Vec4* out, unsigned int count)
+{
+	// Four channels fill one SSE/NEON register, so each color is a single multiply-add
+	const Vec4 delta = to - from;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float clamped = t[i] < 0.0f ? 0.0f : (t[i] > 1.0f ? 1.0f : t[i]);
+		out[i] = from + delta * clamped;
+	}
+}
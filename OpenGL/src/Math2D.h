@@ -0,0 +1,162 @@
+#pragma once
+
+#include<cmath>
+
+#include "Simd.h"
+
+struct Vec2
+{
+	float x, y;
+
+	Vec2() : x(0.0f), y(0.0f) {}
+	Vec2(float x, float y) : x(x), y(y) {}
+
+	inline Vec2 operator+(const Vec2& other) const { return Vec2(x + other.x, y + other.y); }
+	inline Vec2 operator-(const Vec2& other) const { return Vec2(x - other.x, y - other.y); }
+	inline Vec2 operator*(float scale) const { return Vec2(x * scale, y * scale); }
+
+	inline float Dot(const Vec2& other) const { return x * other.x + y * other.y; }
+	inline float Length() const { return std::sqrt(Dot(*this)); }
+	inline Vec2 Normalized() const
+	{
+		float length = Length();
+		return length > 0.0f ? *this * (1.0f / length) : Vec2();
+	}
+};
+
+// Colors and homogeneous points. Aligned so the SSE path can use aligned loads.
+struct alignas(16) Vec4
+{
+	float x, y, z, w;
+
+	Vec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+	Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+#if defined(SIMD_SSE)
+	explicit Vec4(__m128 v) { _mm_store_ps(&x, v); }
+	inline __m128 Load() const { return _mm_load_ps(&x); }
+
+	inline Vec4 operator+(const Vec4& other) const { return Vec4(_mm_add_ps(Load(), other.Load())); }
+	inline Vec4 operator-(const Vec4& other) const { return Vec4(_mm_sub_ps(Load(), other.Load())); }
+	inline Vec4 operator*(const Vec4& other) const { return Vec4(_mm_mul_ps(Load(), other.Load())); }
+	inline Vec4 operator*(float scale) const { return Vec4(_mm_mul_ps(Load(), _mm_set1_ps(scale))); }
+#elif defined(SIMD_NEON)
+	explicit Vec4(float32x4_t v) { vst1q_f32(&x, v); }
+	inline float32x4_t Load() const { return vld1q_f32(&x); }
+
+	inline Vec4 operator+(const Vec4& other) const { return Vec4(vaddq_f32(Load(), other.Load())); }
+	inline Vec4 operator-(const Vec4& other) const { return Vec4(vsubq_f32(Load(), other.Load())); }
+	inline Vec4 operator*(const Vec4& other) const { return Vec4(vmulq_f32(Load(), other.Load())); }
+	inline Vec4 operator*(float scale) const { return Vec4(vmulq_n_f32(Load(), scale)); }
+#else
+	inline Vec4 operator+(const Vec4& other) const { return Vec4(x + other.x, y + other.y, z + other.z, w + other.w); }
+	inline Vec4 operator-(const Vec4& other) const { return Vec4(x - other.x, y - other.y, z - other.z, w - other.w); }
+	inline Vec4 operator*(const Vec4& other) const { return Vec4(x * other.x, y * other.y, z * other.z, w * other.w); }
+	inline Vec4 operator*(float scale) const { return Vec4(x * scale, y * scale, z * scale, w * scale); }
+#endif
+
+	inline float Dot(const Vec4& other) const { return x * other.x + y * other.y + z * other.z + w * other.w; }
+};
+
+inline Vec4 Lerp(const Vec4& from, const Vec4& to, float t) { return from + (to - from) * t; }
+
+// 2D affine transform, column-major like a GLSL mat3:
+//   | m[0] m[3] m[6] |   | a c tx |
+//   | m[1] m[4] m[7] | = | b d ty |
+//   | m[2] m[5] m[8] |   | 0 0 1  |
+struct Mat3
+{
+	float m[9];
+
+	static Mat3 Identity() { return TRS(0.0f, 0.0f, 0.0f, 1.0f, 1.0f); }
+	static Mat3 Translation(float x, float y) { return TRS(x, y, 0.0f, 1.0f, 1.0f); }
+	static Mat3 Rotation(float radians) { return TRS(0.0f, 0.0f, radians, 1.0f, 1.0f); }
+	static Mat3 Scale(float x, float y) { return TRS(0.0f, 0.0f, 0.0f, x, y); }
+	// Translate * Rotate * Scale
+	static Mat3 TRS(float x, float y, float radians, float scaleX, float scaleY)
+	{
+		float c = std::cos(radians), s = std::sin(radians);
+		return Mat3{ { c * scaleX, s * scaleX, 0.0f, -s * scaleY, c * scaleY, 0.0f, x, y, 1.0f } };
+	}
+
+	inline Mat3 operator*(const Mat3& other) const
+	{
+		Mat3 result;
+		for (int column = 0; column < 3; column++)
+			for (int row = 0; row < 3; row++)
+				result.m[column * 3 + row] = m[row] * other.m[column * 3] + m[3 + row] * other.m[column * 3 + 1] + m[6 + row] * other.m[column * 3 + 2];
+		return result;
+	}
+
+	inline Vec2 TransformPoint(const Vec2& p) const { return Vec2(m[0] * p.x + m[3] * p.y + m[6], m[1] * p.x + m[4] * p.y + m[7]); }
+	inline Vec2 TransformVector(const Vec2& v) const { return Vec2(m[0] * v.x + m[3] * v.y, m[1] * v.x + m[4] * v.y); }
+};
+
+// Column-major 4x4, laid out for glUniformMatrix4fv
+struct alignas(16) Mat4
+{
+	float m[16];
+
+	static Mat4 Identity() { return Mat4{ { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 } }; }
+	// Embeds a 2D transform in the xy plane
+	static Mat4 FromMat3(const Mat3& t)
+	{
+		return Mat4{ { t.m[0], t.m[1], 0, 0, t.m[3], t.m[4], 0, 0, 0, 0, 1, 0, t.m[6], t.m[7], 0, 1 } };
+	}
+
+	inline Vec4 operator*(const Vec4& v) const
+	{
+#if defined(SIMD_SSE)
+		__m128 r = _mm_mul_ps(_mm_load_ps(m), _mm_set1_ps(v.x));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(m + 4), _mm_set1_ps(v.y)));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(m + 8), _mm_set1_ps(v.z)));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(m + 12), _mm_set1_ps(v.w)));
+		return Vec4(r);
+#elif defined(SIMD_NEON)
+		float32x4_t r = vmulq_n_f32(vld1q_f32(m), v.x);
+		r = vmlaq_n_f32(r, vld1q_f32(m + 4), v.y);
+		r = vmlaq_n_f32(r, vld1q_f32(m + 8), v.z);
+		r = vmlaq_n_f32(r, vld1q_f32(m + 12), v.w);
+		return Vec4(r);
+#else
+		Vec4 r;
+		float* out = &r.x;
+		for (int row = 0; row < 4; row++)
+			out[row] = m[row] * v.x + m[4 + row] * v.y + m[8 + row] * v.z + m[12 + row] * v.w;
+		return r;
+#endif
+	}
+
+	// Each result column is this matrix times the matching column of other
+	inline Mat4 operator*(const Mat4& other) const
+	{
+		Mat4 result;
+		for (int column = 0; column < 4; column++)
+		{
+			const float* c = other.m + column * 4;
+			Vec4 r = *this * Vec4(c[0], c[1], c[2], c[3]);
+			result.m[column * 4] = r.x;
+			result.m[column * 4 + 1] = r.y;
+			result.m[column * 4 + 2] = r.z;
+			result.m[column * 4 + 3] = r.w;
+		}
+		return result;
+	}
+};
+
+// Batch kernels: AVX, SSE2 or NEON when the compiler targets them, scalar otherwise.
+// Input and output may be the same array.
+
+// Interleaved x, y points
+void TransformPoints(const Mat3& transform, const Vec2* in, Vec2* out, unsigned int count);
+// Separate x and y arrays, as stored by Scene
+void TransformPoints(const Mat3& transform, const float* xIn, const float* yIn, float* xOut, float* yOut, unsigned int count);
+
+// Polynomial sine and cosine, within 2e-7 of std::sin/cos for |angle| < 8192
+void SinCos(const float* angles, float* sines, float* cosines, unsigned int count);
+
+// out[i] = Mat3::TRS(x[i], y[i], rotation[i], scaleX[i], scaleY[i])
+void BuildTRS(const float* x, const float* y, const float* rotation, const float* scaleX, const float* scaleY, Mat3* out, unsigned int count);
+
+// out[i] = Lerp(from, to, t[i]) with t clamped to [0, 1]
+void EvaluateGradient(const Vec4& from, const Vec4& to, const float* t, Vec4* out, unsigned int count);
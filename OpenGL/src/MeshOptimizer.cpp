@@ -0,0 +1,281 @@
+#include "MeshOptimizer.h"
+#include "JobSystem.h"
+
+#include<algorithm>
+#include<cmath>
+#include<cstring>
+
+VertexCacheMetrics AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize)
+{
+	VertexCacheMetrics metrics;
+	if (indexCount < 3)
+		return metrics;
+
+	// Timestamp FIFO: a vertex is cached while fewer than cacheSize misses happened since it was loaded
+	std::vector<unsigned int> loadedAt(vertexCount, 0);
+	std::vector<bool> referenced(vertexCount, false);
+	unsigned int misses = 0, unique = 0;
+
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		unsigned int v = indices[i];
+		if (!referenced[v])
+		{
+			referenced[v] = true;
+			unique++;
+		}
+		if (loadedAt[v] == 0 || misses - loadedAt[v] + 1 > cacheSize)
+		{
+			misses++;
+			loadedAt[v] = misses;
+		}
+	}
+
+	metrics.ACMR = (float)misses / (indexCount / 3);
+	metrics.ATVR = unique ? (float)misses / unique : 0.0f;
+	return metrics;
+}
+
+// Scoring constants from Forsyth's "Linear-Speed Vertex Cache Optimisation"
+static const float CacheDecayPower = 1.5f;
+static const float LastTriScore = 0.75f;
+static const float ValenceBoostScale = 2.0f;
+static const float ValenceBoostPower = 0.5f;
+
+static float CacheScore(int cachePosition, unsigned int cacheSize)
+{
+	if (cachePosition < 0)
+		return 0.0f;
+	if (cachePosition < 3)
+		return LastTriScore;
+	float scaler = 1.0f / (cacheSize - 3);
+	return std::pow(1.0f - (cachePosition - 3) * scaler, CacheDecayPower);
+}
+
+static float ValenceScore(unsigned int remainingValence)
+{
+	return ValenceBoostScale * std::pow((float)remainingValence, -ValenceBoostPower);
+}
+
+// Scores in thousandths, rounded once when the tables are built. Sums of these are
+// exact in float, so every comparison gives the same answer on every platform.
+const unsigned int MaxValenceTable = 64;
+
+struct ScoreTables
+{
+	std::vector<float> cache;
+	float valence[MaxValenceTable];
+
+	explicit ScoreTables(unsigned int cacheSize)
+		: cache(cacheSize)
+	{
+		for (unsigned int i = 0; i < cacheSize; i++)
+			cache[i] = std::floor(CacheScore((int)i, cacheSize) * 1000.0f + 0.5f);
+		valence[0] = 0.0f;
+		for (unsigned int i = 1; i < MaxValenceTable; i++)
+			valence[i] = std::floor(ValenceScore(i) * 1000.0f + 0.5f);
+	}
+};
+
+static float VertexScore(int cachePosition, unsigned int remainingValence, unsigned int cacheSize, const ScoreTables* tables)
+{
+	if (remainingValence == 0)
+		return -1.0f;
+
+	if (tables)
+	{
+		float cache = cachePosition >= 0 ? tables->cache[cachePosition] : 0.0f;
+		return cache + tables->valence[remainingValence < MaxValenceTable ? remainingValence : MaxValenceTable - 1];
+	}
+	return CacheScore(cachePosition, cacheSize) + ValenceScore(remainingValence);
+}
+
+void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize, bool deterministic)
+{
+	const unsigned int triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+		return;
+
+	ScoreTables tableStorage(deterministic ? cacheSize : 0);
+	const ScoreTables* tables = deterministic ? &tableStorage : nullptr;
+
+	std::vector<unsigned int> input(indices, indices + indexCount);
+
+	// Triangles adjacent to each vertex, as one flat array
+	std::vector<unsigned int> valence(vertexCount, 0);
+	for (unsigned int i = 0; i < indexCount; i++)
+		valence[input[i]]++;
+
+	std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+	for (unsigned int v = 0; v < vertexCount; v++)
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + valence[v];
+
+	std::vector<unsigned int> adjacency(indexCount);
+	std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		for (unsigned int k = 0; k < 3; k++)
+			adjacency[fill[input[t * 3 + k]]++] = t;
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (unsigned int v = 0; v < vertexCount; v++)
+		vertexScore[v] = VertexScore(-1, valence[v], cacheSize, tables);
+
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	for (unsigned int t = 0; t < triangleCount; t++)
+		triangleScore[t] = vertexScore[input[t * 3]] + vertexScore[input[t * 3 + 1]] + vertexScore[input[t * 3 + 2]];
+
+	// Cache holds room for the three vertices being pushed in
+	std::vector<unsigned int> cache, newCache;
+	cache.reserve(cacheSize + 3);
+	newCache.reserve(cacheSize + 3);
+
+	unsigned int bestTriangle = 0;
+	float bestScore = triangleScore[0];
+	for (unsigned int t = 1; t < triangleCount; t++)
+	{
+		if (triangleScore[t] > bestScore)
+		{
+			bestScore = triangleScore[t];
+			bestTriangle = t;
+		}
+	}
+
+	unsigned int scanPosition = 0;
+	for (unsigned int written = 0; written < triangleCount; written++)
+	{
+		if (bestScore < 0.0f)
+		{
+			// Nothing in the cache is adjacent to an unused triangle; take the next one in input order
+			while (emitted[scanPosition])
+				scanPosition++;
+			bestTriangle = scanPosition;
+		}
+
+		emitted[bestTriangle] = true;
+		const unsigned int* tri = &input[bestTriangle * 3];
+		for (unsigned int k = 0; k < 3; k++)
+		{
+			unsigned int v = tri[k];
+			destination[written * 3 + k] = v;
+
+			// Remove the triangle from the vertex's adjacency so valence only counts unused triangles
+			unsigned int* begin = &adjacency[adjacencyOffset[v]];
+			unsigned int* end = begin + valence[v];
+			*std::find(begin, end, bestTriangle) = *(end - 1);
+			valence[v]--;
+		}
+
+		// Move the triangle's vertices to the front of the LRU cache
+		newCache.clear();
+		newCache.insert(newCache.end(), tri, tri + 3);
+		for (unsigned int v : cache)
+		{
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+				newCache.push_back(v);
+		}
+		cache.swap(newCache);
+
+		for (unsigned int i = 0; i < cache.size(); i++)
+		{
+			unsigned int v = cache[i];
+			cachePosition[v] = i < cacheSize ? (int)i : -1;
+			vertexScore[v] = VertexScore(cachePosition[v], valence[v], cacheSize, tables);
+		}
+
+		// Rescore triangles touching the cache and pick the best; ties go to the lowest triangle index
+		bestScore = -1.0f;
+		for (unsigned int i = 0; i < cache.size(); i++)
+		{
+			unsigned int v = cache[i];
+			const unsigned int* adjacent = &adjacency[adjacencyOffset[v]];
+			for (unsigned int a = 0; a < valence[v]; a++)
+			{
+				unsigned int t = adjacent[a];
+				const unsigned int* other = &input[t * 3];
+				float score = vertexScore[other[0]] + vertexScore[other[1]] + vertexScore[other[2]];
+				triangleScore[t] = score;
+				if (score > bestScore || (score == bestScore && t < bestTriangle))
+				{
+					bestScore = score;
+					bestTriangle = t;
+				}
+			}
+		}
+
+		if (cache.size() > cacheSize)
+			cache.resize(cacheSize);
+	}
+}
+
+unsigned int OptimizeVertexFetch(float* vertices, unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int floatsPerVertex)
+{
+	const unsigned int Unassigned = 0xFFFFFFFF;
+	std::vector<unsigned int> remap(vertexCount, Unassigned);
+
+	unsigned int next = 0;
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		unsigned int& target = remap[indices[i]];
+		if (target == Unassigned)
+			target = next++;
+		indices[i] = target;
+	}
+
+	std::vector<float> reordered((size_t)next * floatsPerVertex);
+	for (unsigned int v = 0; v < vertexCount; v++)
+	{
+		if (remap[v] != Unassigned)
+			std::memcpy(&reordered[(size_t)remap[v] * floatsPerVertex], &vertices[(size_t)v * floatsPerVertex], floatsPerVertex * sizeof(float));
+	}
+	std::memcpy(vertices, reordered.data(), reordered.size() * sizeof(float));
+	return next;
+}
+
+uint64_t GetMeshHash(const MeshData& mesh, const MeshOptimizeOptions& options)
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](const void* data, size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+	};
+
+	mix(mesh.vertices.data(), mesh.vertices.size() * sizeof(float));
+	mix(mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+	mix(&mesh.floatsPerVertex, sizeof(mesh.floatsPerVertex));
+	mix(&options.cacheSize, sizeof(options.cacheSize));
+	return hash;
+}
+
+MeshOptimizeResult OptimizeMesh(MeshData& mesh, const MeshOptimizeOptions& options)
+{
+	MeshOptimizeResult result;
+	if (options.deterministic)
+		result.inputHash = GetMeshHash(mesh, options);
+
+	const unsigned int vertexCount = (unsigned int)(mesh.vertices.size() / mesh.floatsPerVertex);
+	const unsigned int indexCount = (unsigned int)mesh.indices.size();
+	result.before = AnalyzeVertexCache(mesh.indices.data(), indexCount, vertexCount, options.cacheSize);
+
+	OptimizeVertexCache(mesh.indices.data(), mesh.indices.data(), indexCount, vertexCount, options.cacheSize, options.deterministic);
+
+	unsigned int newVertexCount = OptimizeVertexFetch(mesh.vertices.data(), mesh.indices.data(), indexCount, vertexCount, mesh.floatsPerVertex);
+	mesh.vertices.resize((size_t)newVertexCount * mesh.floatsPerVertex);
+
+	result.after = AnalyzeVertexCache(mesh.indices.data(), indexCount, newVertexCount, options.cacheSize);
+	return result;
+}
+
+void OptimizeMeshes(JobSystem& jobs, MeshData* meshes, unsigned int count, MeshOptimizeResult* results, const MeshOptimizeOptions& options)
+{
+	jobs.ParallelFor(count, 1, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+			results[i] = OptimizeMesh(meshes[i], options);
+	});
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include<cstdint>
+#include<vector>
+
+class JobSystem;
+
+// Triangle-list mesh as it will be uploaded through VertexBuffer/IndexBuffer
+struct MeshData
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	unsigned int floatsPerVertex = 2;
+};
+
+struct VertexCacheMetrics
+{
+	// Vertex shader invocations per triangle; 0.5 is ideal for large grids, 3 is worst
+	float ACMR = 0.0f;
+	// Vertex shader invocations per referenced vertex; 1 is ideal
+	float ATVR = 0.0f;
+};
+
+struct MeshOptimizeOptions
+{
+	// Size of the simulated post-transform cache
+	unsigned int cacheSize = 32;
+	// Scores vertices from integer tables instead of floating-point pow(), so the output is
+	// bit-identical across compilers and FPUs (x87 vs SSE) and can be cached by
+	// MeshOptimizeResult::inputHash
+	bool deterministic = true;
+};
+
+struct MeshOptimizeResult
+{
+	VertexCacheMetrics before;
+	VertexCacheMetrics after;
+	// Hash of the input mesh and options; only filled in deterministic mode
+	uint64_t inputHash = 0;
+};
+
+// FIFO cache simulation, the usual way ACMR/ATVR are reported
+VertexCacheMetrics AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize = 32);
+
+// Tom Forsyth's linear-speed vertex cache optimisation. destination may equal indices.
+void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize = 32, bool deterministic = true);
+
+// Reorders vertices by first use so fetches walk memory linearly, rewriting indices to
+// match. Unreferenced vertices are dropped; returns the new vertex count.
+unsigned int OptimizeVertexFetch(float* vertices, unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int floatsPerVertex);
+
+uint64_t GetMeshHash(const MeshData& mesh, const MeshOptimizeOptions& options);
+
+// Cache then fetch optimisation in place
+MeshOptimizeResult OptimizeMesh(MeshData& mesh, const MeshOptimizeOptions& options = MeshOptimizeOptions());
+// Optimises every mesh, one job per mesh
+void OptimizeMeshes(JobSystem& jobs, MeshData* meshes, unsigned int count, MeshOptimizeResult* results, const MeshOptimizeOptions& options = MeshOptimizeOptions());
@@ -0,0 +1,240 @@
+#include "ParticleSystem.h"
+#include "CircleLOD.h"
+#include "JobSystem.h"
+#include "SimdFloats.h"
+
+#include<chrono>
+#include<cmath>
+#include<utility>
+
+// Particles per job; a multiple of every SIMD width
+const unsigned int PARTICLE_CHUNK_SIZE = 8192;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static float MillisecondsSince(Clock::time_point start)
+{
+	return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+
+static inline unsigned int CountBits(unsigned int bits)
+{
+	unsigned int count = 0;
+	for (; bits != 0; bits &= bits - 1)
+		count++;
+	return count;
+}
+
+ParticleSystem::ParticleSystem(unsigned int capacity, unsigned int seed)
+	: m_Count(0), m_Capacity(capacity), m_EmitAccumulator(0.0f), m_RandomState(seed ? seed : 1)
+{
+	m_Front.ForEachArray([capacity](std::vector<float>& values) { values.resize(capacity); });
+	m_Back.ForEachArray([capacity](std::vector<float>& values) { values.resize(capacity); });
+	m_ChunkAlive.resize((capacity + PARTICLE_CHUNK_SIZE - 1) / PARTICLE_CHUNK_SIZE);
+}
+
+float ParticleSystem::Random()
+{
+	// xorshift32; the top 24 bits fill a float mantissa exactly
+	m_RandomState ^= m_RandomState << 13;
+	m_RandomState ^= m_RandomState >> 17;
+	m_RandomState ^= m_RandomState << 5;
+	return (float)(m_RandomState >> 8) * (1.0f / 16777216.0f);
+}
+
+void ParticleSystem::Clear()
+{
+	m_Count = 0;
+	m_EmitAccumulator = 0.0f;
+}
+
+void ParticleSystem::Spawn(unsigned int count)
+{
+	if (count > m_Capacity - m_Count)
+		count = m_Capacity - m_Count;
+
+	const ParticleEmitter& emitter = m_Emitter;
+	for (unsigned int i = m_Count; i < m_Count + count; i++)
+	{
+		const float angle = emitter.angle + (2.0f * Random() - 1.0f) * emitter.spread;
+		const float speed = emitter.minSpeed + (emitter.maxSpeed - emitter.minSpeed) * Random();
+		const float lifetime = emitter.minLifetime + (emitter.maxLifetime - emitter.minLifetime) * Random();
+
+		m_Front.x[i] = emitter.x;
+		m_Front.y[i] = emitter.y;
+		m_Front.velocityX[i] = std::cos(angle) * speed;
+		m_Front.velocityY[i] = std::sin(angle) * speed;
+		m_Front.age[i] = 0.0f;
+		m_Front.inverseLifetime[i] = lifetime > 0.0f ? 1.0f / lifetime : 1e30f;
+	}
+
+	m_Count += count;
+	m_Stats.Emitted += count;
+}
+
+void ParticleSystem::Burst(unsigned int count)
+{
+	Spawn(count);
+	m_Stats.Alive = m_Count;
+}
+
+void ParticleSystem::Update(JobSystem& jobs, float dt)
+{
+	m_Stats.Emitted = 0;
+
+	Clock::time_point start = Clock::now();
+	m_EmitAccumulator += m_Emitter.rate * dt;
+	const unsigned int emit = (unsigned int)m_EmitAccumulator;
+	m_EmitAccumulator -= (float)emit;
+	Spawn(emit);
+	m_Stats.EmitMs = MillisecondsSince(start);
+
+	// Survivors are the particles still short of their lifetime after this step; count
+	// them per chunk first, so the integration can write straight to compacted positions
+	start = Clock::now();
+	const unsigned int count = m_Count;
+	const unsigned int chunks = (count + PARTICLE_CHUNK_SIZE - 1) / PARTICLE_CHUNK_SIZE;
+	jobs.ParallelFor(count, PARTICLE_CHUNK_SIZE, [&](unsigned int begin, unsigned int end)
+	{
+		const float* age = m_Front.age.data();
+		const float* inverseLifetime = m_Front.inverseLifetime.data();
+		const Floats step = Set(dt), one = Set(1.0f);
+
+		unsigned int alive = 0;
+		unsigned int i = begin;
+		for (; i + WIDTH <= end; i += WIDTH)
+			alive += CountBits(MaskBits(Less(Mul(Add(Load(age + i), step), Load(inverseLifetime + i)), one)));
+		for (; i < end; i++)
+			alive += (age[i] + dt) * inverseLifetime[i] < 1.0f ? 1 : 0;
+		m_ChunkAlive[begin / PARTICLE_CHUNK_SIZE] = alive;
+	});
+
+	unsigned int survivors = 0;
+	for (unsigned int c = 0; c < chunks; c++)
+	{
+		const unsigned int alive = m_ChunkAlive[c];
+		m_ChunkAlive[c] = survivors;
+		survivors += alive;
+	}
+	m_Stats.CompactMs = MillisecondsSince(start);
+
+	// Integrate from the front arrays into the back ones, each chunk at its own offset.
+	// Registers with no deaths are stored whole; the rest go out lane by lane.
+	start = Clock::now();
+	const float damping = std::pow(m_Emitter.damping, dt);
+	const float gravityX = m_Emitter.gravityX * dt, gravityY = m_Emitter.gravityY * dt;
+
+	jobs.ParallelFor(count, PARTICLE_CHUNK_SIZE, [&](unsigned int begin, unsigned int end)
+	{
+		const Arrays& from = m_Front;
+		Arrays& to = m_Back;
+		const Floats step = Set(dt), keep = Set(damping), one = Set(1.0f);
+		const Floats accelerationX = Set(gravityX), accelerationY = Set(gravityY);
+		const unsigned int allLanes = (1u << WIDTH) - 1;
+
+		unsigned int o = m_ChunkAlive[begin / PARTICLE_CHUNK_SIZE];
+		unsigned int i = begin;
+		for (; i + WIDTH <= end; i += WIDTH)
+		{
+			const Floats inverseLifetime = Load(&from.inverseLifetime[i]);
+			const Floats age = Add(Load(&from.age[i]), step);
+			const unsigned int alive = MaskBits(Less(Mul(age, inverseLifetime), one));
+			if (alive == 0)
+				continue;
+
+			const Floats vx = Add(Mul(Load(&from.velocityX[i]), keep), accelerationX);
+			const Floats vy = Add(Mul(Load(&from.velocityY[i]), keep), accelerationY);
+			const Floats x = Add(Load(&from.x[i]), Mul(vx, step));
+			const Floats y = Add(Load(&from.y[i]), Mul(vy, step));
+
+			if (alive == allLanes)
+			{
+				Store(&to.x[o], x);
+				Store(&to.y[o], y);
+				Store(&to.velocityX[o], vx);
+				Store(&to.velocityY[o], vy);
+				Store(&to.age[o], age);
+				Store(&to.inverseLifetime[o], inverseLifetime);
+				o += WIDTH;
+				continue;
+			}
+
+			float lanes[6][WIDTH];
+			Store(lanes[0], x);
+			Store(lanes[1], y);
+			Store(lanes[2], vx);
+			Store(lanes[3], vy);
+			Store(lanes[4], age);
+			Store(lanes[5], inverseLifetime);
+			for (unsigned int lane = 0; lane < WIDTH; lane++)
+			{
+				if (!(alive & (1u << lane)))
+					continue;
+				to.x[o] = lanes[0][lane];
+				to.y[o] = lanes[1][lane];
+				to.velocityX[o] = lanes[2][lane];
+				to.velocityY[o] = lanes[3][lane];
+				to.age[o] = lanes[4][lane];
+				to.inverseLifetime[o] = lanes[5][lane];
+				o++;
+			}
+		}
+		for (; i < end; i++)
+		{
+			const float age = from.age[i] + dt;
+			if (age * from.inverseLifetime[i] >= 1.0f)
+				continue;
+
+			to.velocityX[o] = from.velocityX[i] * damping + gravityX;
+			to.velocityY[o] = from.velocityY[i] * damping + gravityY;
+			to.x[o] = from.x[i] + to.velocityX[o] * dt;
+			to.y[o] = from.y[i] + to.velocityY[o] * dt;
+			to.age[o] = age;
+			to.inverseLifetime[o] = from.inverseLifetime[i];
+			o++;
+		}
+	});
+	std::swap(m_Front, m_Back);
+	m_Stats.SimulateMs = MillisecondsSince(start);
+
+	m_Stats.Killed = count - survivors;
+	m_Stats.Alive = m_Count = survivors;
+}
+
+unsigned int ParticleSystem::WriteInstances(JobSystem& jobs, CircleInstance* out, unsigned int maxCount)
+{
+	Clock::time_point start = Clock::now();
+	const unsigned int count = m_Count < maxCount ? m_Count : maxCount;
+
+	// Locals, since the stores through out could otherwise alias the emitter's floats
+	const ParticleEmitter& emitter = m_Emitter;
+	const float radius = emitter.startRadius, radiusChange = emitter.endRadius - emitter.startRadius;
+	const float red = emitter.startColor[0], redChange = emitter.endColor[0] - red;
+	const float green = emitter.startColor[1], greenChange = emitter.endColor[1] - green;
+	const float blue = emitter.startColor[2], blueChange = emitter.endColor[2] - blue;
+	const float alpha = emitter.startColor[3], alphaChange = emitter.endColor[3] - alpha;
+
+	jobs.ParallelFor(count, PARTICLE_CHUNK_SIZE, [&](unsigned int begin, unsigned int end)
+	{
+		const float* x = m_Front.x.data();
+		const float* y = m_Front.y.data();
+		const float* age = m_Front.age.data();
+		const float* inverseLifetime = m_Front.inverseLifetime.data();
+
+		for (unsigned int i = begin; i < end; i++)
+		{
+			const float t = age[i] * inverseLifetime[i];
+			CircleInstance& instance = out[i];
+			instance.x = x[i];
+			instance.y = y[i];
+			instance.radius = radius + radiusChange * t;
+			instance.color[0] = red + redChange * t;
+			instance.color[1] = green + greenChange * t;
+			instance.color[2] = blue + blueChange * t;
+			instance.color[3] = alpha + alphaChange * t;
+		}
+	});
+
+	m_Stats.WriteMs = MillisecondsSince(start);
+	return count;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include<vector>
+
+class JobSystem;
+struct CircleInstance;
+
+// Where and how new particles are born; each range is sampled uniformly per particle
+struct ParticleEmitter
+{
+	float x = 0.0f, y = 0.0f;
+	// Particles per second
+	float rate = 1000.0f;
+	// Direction in radians, and the most a particle may deviate from it either way
+	float angle = 1.5707963f, spread = 3.1415927f;
+	float minSpeed = 0.1f, maxSpeed = 0.3f;
+	// Seconds
+	float minLifetime = 0.5f, maxLifetime = 1.5f;
+	// Radius and color run linearly from start to end over a particle's life
+	float startRadius = 0.01f, endRadius = 0.0f;
+	float startColor[4] = { 1.0f, 0.8f, 0.2f, 1.0f };
+	float endColor[4] = { 1.0f, 0.1f, 0.0f, 0.0f };
+	// Constant acceleration, and the fraction of velocity kept per second
+	float gravityX = 0.0f, gravityY = -0.5f;
+	float damping = 0.9f;
+};
+
+struct ParticleStats
+{
+	unsigned int Alive = 0;
+	unsigned int Emitted = 0;
+	unsigned int Killed = 0;
+	// Milliseconds spent in each stage of the last Update() and WriteInstances();
+	// CompactMs covers counting the survivors and placing the chunks
+	float EmitMs = 0.0f;
+	float SimulateMs = 0.0f;
+	float CompactMs = 0.0f;
+	float WriteMs = 0.0f;
+};
+
+// One emitter's particles, stored as structure-of-arrays and simulated with SIMD across
+// the job system. Each step is a stream compaction: survivors are counted per chunk, then
+// integrated from one set of arrays straight into their packed positions in a second set.
+// Live particles stay in birth order, so results are the same for any thread count.
+// WriteInstances() streams them out as Circle.shader instances, e.g. straight into a
+// mapped instance buffer.
+class ParticleSystem
+{
+private:
+	struct Arrays
+	{
+		std::vector<float> x, y;
+		std::vector<float> velocityX, velocityY;
+		std::vector<float> age;
+		std::vector<float> inverseLifetime;
+
+		template<typename Op>
+		void ForEachArray(Op op)
+		{
+			op(x); op(y);
+			op(velocityX); op(velocityY);
+			op(age); op(inverseLifetime);
+		}
+	};
+
+	Arrays m_Front, m_Back;
+	unsigned int m_Count;
+	unsigned int m_Capacity;
+	ParticleEmitter m_Emitter;
+	// Fractional particles carried over to the next Update()
+	float m_EmitAccumulator;
+	unsigned int m_RandomState;
+	// Survivors per chunk, then each chunk's first output index
+	std::vector<unsigned int> m_ChunkAlive;
+	ParticleStats m_Stats;
+
+public:
+	explicit ParticleSystem(unsigned int capacity, unsigned int seed = 1);
+
+	inline ParticleEmitter& GetEmitter() { return m_Emitter; }
+	inline const ParticleEmitter& GetEmitter() const { return m_Emitter; }
+
+	// Spawns count particles now, on top of the emitter's rate; stops at capacity
+	void Burst(unsigned int count);
+	// Emits at the emitter's rate, advances every particle by dt and removes the dead
+	void Update(JobSystem& jobs, float dt);
+	// Writes up to maxCount live particles as CircleInstance records. Returns the number written.
+	unsigned int WriteInstances(JobSystem& jobs, CircleInstance* out, unsigned int maxCount);
+
+	void Clear();
+
+	inline unsigned int GetCount() const { return m_Count; }
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+	inline const ParticleStats& GetStats() const { return m_Stats; }
+
+	inline const float* GetX() const { return m_Front.x.data(); }
+	inline const float* GetY() const { return m_Front.y.data(); }
+	inline const float* GetAge() const { return m_Front.age.data(); }
+
+private:
+	void Spawn(unsigned int count);
+	// Uniform in [0, 1)
+	float Random();
+};
@@ -0,0 +1,189 @@
+#include "PickingBuffer.h"
+#include "GLState.h"
+
+#include<algorithm>
+
+PickingBuffer::PickingBuffer(int width, int height)
+	: m_Width(width), m_Height(height), m_FirstPending(0), m_PendingCount(0)
+{
+	GLState& state = GLState::Get();
+
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		glCreateTextures(GL_TEXTURE_2D, 1, &m_Texture);
+		glTextureStorage2D(m_Texture, 1, GL_R32UI, width, height);
+		glTextureParameteri(m_Texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTextureParameteri(m_Texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		glCreateFramebuffers(1, &m_RendererID);
+		glNamedFramebufferTexture(m_RendererID, GL_COLOR_ATTACHMENT0, m_Texture, 0);
+		glNamedFramebufferReadBuffer(m_RendererID, GL_COLOR_ATTACHMENT0);
+		ASSERT(glCheckNamedFramebufferStatus(m_RendererID, GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+		for (Readback& readback : m_Readbacks)
+			glCreateBuffers(1, &readback.buffer);
+	}
+	else
+	{
+		glGenTextures(1, &m_Texture);
+		state.BindTexture(0, GL_TEXTURE_2D, m_Texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, width, height, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		glGenFramebuffers(1, &m_RendererID);
+		state.BindFramebuffer(m_RendererID);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_Texture, 0);
+		glReadBuffer(GL_COLOR_ATTACHMENT0);
+		ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+		state.BindFramebuffer(0);
+
+		for (Readback& readback : m_Readbacks)
+			glGenBuffers(1, &readback.buffer);
+	}
+
+	for (Readback& readback : m_Readbacks)
+	{
+		readback.capacity = 0;
+		readback.fence = nullptr;
+	}
+}
+
+PickingBuffer::~PickingBuffer()
+{
+	GLState& state = GLState::Get();
+
+	for (Readback& readback : m_Readbacks)
+	{
+		if (readback.fence)
+			glDeleteSync(readback.fence);
+		state.OnBufferDeleted(readback.buffer);
+		glDeleteBuffers(1, &readback.buffer);
+	}
+
+	state.OnFramebufferDeleted(m_RendererID);
+	glDeleteFramebuffers(1, &m_RendererID);
+	state.OnTextureDeleted(m_Texture);
+	glDeleteTextures(1, &m_Texture);
+}
+
+void PickingBuffer::Begin()
+{
+	GLState& state = GLState::Get();
+	state.BindFramebuffer(m_RendererID);
+	state.Viewport(0, 0, m_Width, m_Height);
+
+	// Blending is ignored for integer attachments, so IDs are written as they are
+	const GLuint nothing[4] = { 0, 0, 0, 0 };
+	glClearBufferuiv(GL_COLOR, 0, nothing);
+}
+
+void PickingBuffer::End(int viewportWidth, int viewportHeight)
+{
+	GLState& state = GLState::Get();
+	state.BindFramebuffer(0);
+	state.Viewport(0, 0, viewportWidth, viewportHeight);
+}
+
+bool PickingBuffer::RequestRead(int x, int y, int width, int height)
+{
+	// Clip to the buffer
+	if (x < 0) { width += x; x = 0; }
+	if (y < 0) { height += y; y = 0; }
+	if (x + width > m_Width) width = m_Width - x;
+	if (y + height > m_Height) height = m_Height - y;
+	if (width <= 0 || height <= 0 || m_PendingCount == MaxPendingReads)
+		return false;
+
+	Readback& readback = m_Readbacks[(m_FirstPending + m_PendingCount) % MaxPendingReads];
+	readback.x = x;
+	readback.y = y;
+	readback.width = width;
+	readback.height = height;
+
+	GLState& state = GLState::Get();
+	const unsigned int size = (unsigned int)(width * height) * sizeof(GLuint);
+	if (size > readback.capacity)
+	{
+		if (GLGetCapabilities().DirectStateAccess)
+		{
+			glNamedBufferData(readback.buffer, size, nullptr, GL_STREAM_READ);
+		}
+		else
+		{
+			state.BindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+			glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+		}
+		readback.capacity = size;
+	}
+
+	// With a pack buffer bound, glReadPixels only queues the copy
+	state.BindFramebuffer(m_RendererID);
+	state.BindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+	glReadPixels(x, y, width, height, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+	state.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	state.BindFramebuffer(0);
+
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_PendingCount++;
+	return true;
+}
+
+bool PickingBuffer::Poll(PickResult& result)
+{
+	if (m_PendingCount == 0)
+		return false;
+
+	Readback& readback = m_Readbacks[m_FirstPending];
+	// Timeout 0 just checks; the flush makes sure the fence is on its way to the GPU
+	GLenum status = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if (status == GL_TIMEOUT_EXPIRED)
+		return false;
+	ASSERT(status != GL_WAIT_FAILED);
+
+	glDeleteSync(readback.fence);
+	readback.fence = nullptr;
+	m_FirstPending = (m_FirstPending + 1) % MaxPendingReads;
+	m_PendingCount--;
+
+	const unsigned int pixels = (unsigned int)(readback.width * readback.height);
+	const GLuint* ids;
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		ids = (const GLuint*)glMapNamedBufferRange(readback.buffer, 0, pixels * sizeof(GLuint), GL_MAP_READ_BIT);
+	}
+	else
+	{
+		GLState::Get().BindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		ids = (const GLuint*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, pixels * sizeof(GLuint), GL_MAP_READ_BIT);
+	}
+	ASSERT(ids);
+
+	result.x = readback.x;
+	result.y = readback.y;
+	result.width = readback.width;
+	result.height = readback.height;
+	result.ids.clear();
+
+	// Neighbouring pixels mostly share an ID, so drop runs before sorting
+	GLuint previous = 0;
+	for (unsigned int i = 0; i < pixels; i++)
+	{
+		if (ids[i] != previous && ids[i] != 0)
+			result.ids.push_back(ids[i]);
+		previous = ids[i];
+	}
+	std::sort(result.ids.begin(), result.ids.end());
+	result.ids.erase(std::unique(result.ids.begin(), result.ids.end()), result.ids.end());
+
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		glUnmapNamedBuffer(readback.buffer);
+	}
+	else
+	{
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		GLState::Get().BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include<vector>
+
+#include "Renderer.h"
+
+struct PickResult
+{
+	// The rectangle that was read, in framebuffer pixels with y up
+	int x, y, width, height;
+	// Distinct non-zero IDs found in it, ascending
+	std::vector<unsigned int> ids;
+};
+
+// Offscreen framebuffer with a GL_R32UI color attachment that shapes draw their IDs into
+// (see PickID.shader and PickCircle.shader; 0 is reserved for "nothing"). Reads go
+// through pixel pack buffers and complete asynchronously: RequestRead() queues the copy
+// and returns immediately, Poll() hands the result over once its fence has signaled,
+// normally a frame or two later, so picking never stalls the pipeline.
+class PickingBuffer
+{
+private:
+	static const unsigned int MaxPendingReads = 3;
+
+	struct Readback
+	{
+		unsigned int buffer;
+		unsigned int capacity;
+		GLsync fence;
+		int x, y, width, height;
+	};
+
+	unsigned int m_RendererID;
+	unsigned int m_Texture;
+	int m_Width, m_Height;
+	Readback m_Readbacks[MaxPendingReads];
+	// Oldest pending read and number pending; reads complete in the order they were queued
+	unsigned int m_FirstPending;
+	unsigned int m_PendingCount;
+
+public:
+	PickingBuffer(int width, int height);
+	~PickingBuffer();
+
+	PickingBuffer(const PickingBuffer&) = delete;
+	PickingBuffer& operator=(const PickingBuffer&) = delete;
+
+	// Binds the framebuffer, sets the viewport to cover it and clears every ID to 0
+	void Begin();
+	// Rebinds the default framebuffer with the given viewport
+	void End(int viewportWidth, int viewportHeight);
+
+	// Queues a copy of the rectangle, clipped to the buffer. Call after End(). Returns
+	// false if the rectangle is empty or MaxPendingReads reads are already in flight.
+	bool RequestRead(int x, int y, int width, int height);
+	// Takes the oldest read if it has finished; never waits
+	bool Poll(PickResult& result);
+
+	inline unsigned int GetPendingCount() const { return m_PendingCount; }
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+};
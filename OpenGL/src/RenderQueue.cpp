@@ -0,0 +1,135 @@
+#include "RenderQueue.h"
+#include "GLState.h"
+
+#include<new>
+
+RenderQueue::RenderQueue(unsigned int maxDraws)
+	: m_Allocator(maxDraws * sizeof(DrawCall) + alignof(DrawCall))
+{
+	m_Items.reserve(maxDraws);
+	m_Scratch.reserve(maxDraws);
+}
+
+void RenderQueue::Begin()
+{
+	m_Allocator.Reset();
+	m_Items.clear();
+}
+
+void RenderQueue::Submit(const DrawCall& draw)
+{
+	DrawCall* recorded = m_Allocator.Allocate<DrawCall>();
+	ASSERT(recorded);
+	if (!recorded)
+		return;
+	new (recorded) DrawCall(draw);
+
+	uint64_t key = MakeSortKey(draw.layer, draw.shader->GetRendererID(), draw.vertexArray->GetRendererID(), draw.texture, draw.depth);
+	m_Items.push_back({ key, recorded });
+}
+
+void RenderQueue::Flush()
+{
+	m_Stats.Draws = m_Items.size();
+	m_Stats.StateChangesUnsorted = CountStateChanges(m_Items);
+	RadixSort();
+	m_Stats.StateChangesSorted = CountStateChanges(m_Items);
+
+	GLState& state = GLState::Get();
+	for (const SortItem& item : m_Items)
+	{
+		const DrawCall& draw = *item.draw;
+
+		draw.shader->Bind();
+		draw.shader->SetUniform4f("u_Color", draw.color[0], draw.color[1], draw.color[2], draw.color[3]);
+		draw.shader->SetUniform2f("u_Offset", draw.offset[0], draw.offset[1]);
+		if (draw.animationTrack >= 0)
+			draw.shader->SetUniform1ui("u_Track", (unsigned int)draw.animationTrack);
+
+		draw.vertexArray->Bind();
+		if (draw.vertexBuffer)
+			draw.vertexArray->BindVertexBuffer(*draw.vertexBuffer);
+		draw.indexBuffer->Bind();
+
+		if (draw.texture)
+			state.BindTexture(0, GL_TEXTURE_2D, draw.texture);
+
+		glDrawElements(draw.mode, draw.indexBuffer->GetCount(), GL_UNSIGNED_INT, nullptr);
+	}
+}
+
+uint64_t RenderQueue::MakeSortKey(unsigned char layer, unsigned int shader, unsigned int vertexArray, unsigned int texture, float depth)
+{
+	if (depth < 0.0f)
+		depth = 0.0f;
+	else if (depth > 1.0f)
+		depth = 1.0f;
+	uint64_t quantizedDepth = (uint64_t)(depth * 0xFFFFF);
+
+	return ((uint64_t)layer << 56)
+		| ((uint64_t)(shader & 0xFFF) << 44)
+		| ((uint64_t)(vertexArray & 0xFFF) << 32)
+		| ((uint64_t)(texture & 0xFFF) << 20)
+		| quantizedDepth;
+}
+
+void RenderQueue::RadixSort()
+{
+	const size_t count = m_Items.size();
+	m_Scratch.resize(count);
+
+	SortItem* src = m_Items.data();
+	SortItem* dst = m_Scratch.data();
+
+	// LSD radix sort, one byte per pass; stable, so equal keys keep submission order
+	for (unsigned int shift = 0; shift < 64; shift += 8)
+	{
+		size_t histogram[256] = {};
+		for (size_t i = 0; i < count; i++)
+			histogram[(src[i].key >> shift) & 0xFF]++;
+
+		// Every key shares this byte, the pass would not move anything
+		if (count == 0 || histogram[(src[0].key >> shift) & 0xFF] == count)
+			continue;
+
+		size_t offset = 0;
+		for (unsigned int b = 0; b < 256; b++)
+		{
+			size_t n = histogram[b];
+			histogram[b] = offset;
+			offset += n;
+		}
+
+		for (size_t i = 0; i < count; i++)
+			dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+		SortItem* tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	if (src != m_Items.data())
+		m_Items.swap(m_Scratch);
+}
+
+unsigned int RenderQueue::CountStateChanges(const std::vector<SortItem>& items)
+{
+	unsigned int changes = 0;
+	const DrawCall* previous = nullptr;
+	for (const SortItem& item : items)
+	{
+		const DrawCall* draw = item.draw;
+		if (!previous || draw->shader != previous->shader)
+			changes++;
+		if (!previous || draw->vertexArray != previous->vertexArray)
+			changes++;
+		if (draw->vertexBuffer && (!previous || draw->vertexBuffer != previous->vertexBuffer))
+			changes++;
+		if (!previous || draw->indexBuffer != previous->indexBuffer)
+			changes++;
+		if (draw->texture && (!previous || draw->texture != previous->texture))
+			changes++;
+		previous = draw;
+	}
+	return changes;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include<cstdint>
+#include<vector>
+
+#include "LinearAllocator.h"
+#include "Shader.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+
+struct DrawCall
+{
+	Shader* shader = nullptr;
+	const VertexArray* vertexArray = nullptr;
+	// Only needed when the vertex array describes a format without a buffer (see VertexArrayCache)
+	const VertexBuffer* vertexBuffer = nullptr;
+	const IndexBuffer* indexBuffer = nullptr;
+	unsigned int texture = 0;
+	unsigned int mode = GL_TRIANGLES;
+
+	// Basic.shader conventions
+	float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	float offset[2] = { 0.0f, 0.0f };
+	// AnimationSet track for Animated.shader, which the color tints; -1 for other shaders
+	int animationTrack = -1;
+
+	unsigned char layer = 0;
+	// 0 = near, 1 = far
+	float depth = 0.0f;
+};
+
+struct RenderQueueStats
+{
+	unsigned int Draws = 0;
+	// Shader/vertex array/buffer/texture switches in submission order and after sorting
+	unsigned int StateChangesUnsorted = 0;
+	unsigned int StateChangesSorted = 0;
+};
+
+// Records a frame's draws, sorts them by a 64-bit key and submits them in order
+// so that draws sharing a shader, vertex array and texture run back to back.
+//
+// Key layout (most significant first):
+//   layer 8 | shader 12 | vertex array 12 | texture 12 | depth 20
+class RenderQueue
+{
+private:
+	struct SortItem
+	{
+		uint64_t key;
+		const DrawCall* draw;
+	};
+
+	LinearAllocator m_Allocator;
+	std::vector<SortItem> m_Items;
+	std::vector<SortItem> m_Scratch;
+	RenderQueueStats m_Stats;
+
+public:
+	explicit RenderQueue(unsigned int maxDraws = 4096);
+
+	// Starts a new frame; draws recorded in the previous frame are discarded
+	void Begin();
+	void Submit(const DrawCall& draw);
+	// Sorts and issues every draw recorded since Begin()
+	void Flush();
+
+	inline const RenderQueueStats& GetStats() const { return m_Stats; }
+
+	static uint64_t MakeSortKey(unsigned char layer, unsigned int shader, unsigned int vertexArray, unsigned int texture, float depth);
+
+private:
+	void RadixSort();
+	static unsigned int CountStateChanges(const std::vector<SortItem>& items);
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include<vector>
+
+#include "Shader.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+
+// Index into RenderResources. Plain data, so worker threads can copy it around
+// without touching the GL object it names.
+template<typename T>
+struct ResourceHandle
+{
+	unsigned int index = 0xFFFFFFFF;
+
+	inline bool IsValid() const { return index != 0xFFFFFFFF; }
+};
+
+typedef ResourceHandle<Shader> ShaderHandle;
+typedef ResourceHandle<VertexArray> VertexArrayHandle;
+typedef ResourceHandle<VertexBuffer> VertexBufferHandle;
+typedef ResourceHandle<IndexBuffer> IndexBufferHandle;
+
+// Maps handles to the objects owned elsewhere. Register objects on the render thread
+// before recording starts; lookups only happen when command lists are executed.
+class RenderResources
+{
+private:
+	std::vector<Shader*> m_Shaders;
+	std::vector<const VertexArray*> m_VertexArrays;
+	std::vector<const VertexBuffer*> m_VertexBuffers;
+	std::vector<const IndexBuffer*> m_IndexBuffers;
+
+public:
+	inline ShaderHandle Add(Shader& shader) { return ShaderHandle{ Push(m_Shaders, &shader) }; }
+	inline VertexArrayHandle Add(const VertexArray& va) { return VertexArrayHandle{ Push(m_VertexArrays, &va) }; }
+	inline VertexBufferHandle Add(const VertexBuffer& vb) { return VertexBufferHandle{ Push(m_VertexBuffers, &vb) }; }
+	inline IndexBufferHandle Add(const IndexBuffer& ib) { return IndexBufferHandle{ Push(m_IndexBuffers, &ib) }; }
+
+	inline Shader* Get(ShaderHandle handle) const { return m_Shaders[handle.index]; }
+	inline const VertexArray* Get(VertexArrayHandle handle) const { return m_VertexArrays[handle.index]; }
+	inline const VertexBuffer* Get(VertexBufferHandle handle) const { return m_VertexBuffers[handle.index]; }
+	inline const IndexBuffer* Get(IndexBufferHandle handle) const { return m_IndexBuffers[handle.index]; }
+
+private:
+	template<typename T>
+	static unsigned int Push(std::vector<T*>& objects, T* object)
+	{
+		objects.push_back(object);
+		return (unsigned int)objects.size() - 1;
+	}
+};
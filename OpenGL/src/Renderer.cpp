@@ -14,4 +14,33 @@ bool GLLogCall(const char* function, const char* file, int line)
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+static GLCapabilities s_Capabilities;
+
+void GLLoadCapabilities()
+{
+    s_Capabilities.DirectStateAccess = GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access;
+    s_Capabilities.VertexAttribBinding = GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding;
+    s_Capabilities.MultiDrawIndirect = GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance);
+    s_Capabilities.PrimitiveRestartFixedIndex = GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility;
+    // The compute shaders are written against #version 430, which the extensions alone don't provide
+    s_Capabilities.ComputeShader = GLEW_VERSION_4_3;
+    if (GLEW_VERSION_4_3)
+    {
+        GLint vertexBlocks = 0;
+        glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &vertexBlocks);
+        s_Capabilities.VertexShaderStorage = vertexBlocks >= 2;
+    }
+
+    std::cout << "[Debug] Direct state access: " << (s_Capabilities.DirectStateAccess ? "yes" : "no") << std::endl;
+    std::cout << "[Debug] Vertex attrib binding: " << (s_Capabilities.VertexAttribBinding ? "yes" : "no") << std::endl;
+    std::cout << "[Debug] Multi-draw indirect: " << (s_Capabilities.MultiDrawIndirect ? "yes" : "no") << std::endl;
+    std::cout << "[Debug] Compute shaders: " << (s_Capabilities.ComputeShader ? "yes" : "no") << std::endl;
+    std::cout << "[Debug] Vertex shader storage: " << (s_Capabilities.VertexShaderStorage ? "yes" : "no") << std::endl;
+}
+
+const GLCapabilities& GLGetCapabilities()
+{
+    return s_Capabilities;
+}
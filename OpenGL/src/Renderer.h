@@ -10,3 +10,25 @@
 
 void GLClearError();
 bool GLLogCall(const char* function, const char* file, int line);
+
+struct GLCapabilities
+{
+    // GL 4.5 / ARB_direct_state_access: edit objects without binding them
+    bool DirectStateAccess = false;
+    // GL 4.3 / ARB_vertex_attrib_binding: vertex format separate from the buffer it reads
+    bool VertexAttribBinding = false;
+    // GL 4.3 / ARB_multi_draw_indirect + ARB_base_instance: many draws from one indirect buffer
+    bool MultiDrawIndirect = false;
+    // GL 4.3 / ARB_ES3_compatibility: restart on the index type's maximum value
+    bool PrimitiveRestartFixedIndex = false;
+    // GL 4.3: compute passes that write draw commands the GPU then consumes itself. The
+    // ARB extensions alone don't count, since the shaders are #version 430.
+    bool ComputeShader = false;
+    // GL 4.3 with at least two storage blocks in the vertex stage, where 4.3 only requires
+    // zero: per-object data looked up by vertex shaders, e.g. Animated.shader
+    bool VertexShaderStorage = false;
+};
+
+// Queries the current context. Call once after glewInit() and before creating any GL objects.
+void GLLoadCapabilities();
+const GLCapabilities& GLGetCapabilities();
@@ -0,0 +1,138 @@
+#include "Scene.h"
+#include "CircleLOD.h"
+
+const unsigned int NO_SLOT = 0xFFFFFFFF;
+
+Scene::Scene()
+	: m_FreeSlot(NO_SLOT)
+{
+}
+
+void Scene::Reserve(unsigned int count)
+{
+	ForEachArray([count](std::vector<float>& values) { values.reserve(count); });
+	m_DenseToSlot.reserve(count);
+	m_Slots.reserve(count);
+}
+
+void Scene::Clear()
+{
+	// Destroy every entity so outstanding handles go stale
+	while (GetCount() > 0)
+		Destroy(GetHandle(GetCount() - 1));
+}
+
+EntityHandle Scene::Create(float x, float y, float radius, const float color[4], float velocityX, float velocityY)
+{
+	const unsigned int index = GetCount();
+
+	unsigned int slot = m_FreeSlot;
+	if (slot != NO_SLOT)
+	{
+		m_FreeSlot = m_Slots[slot].index;
+		m_Slots[slot].index = index;
+	}
+	else
+	{
+		slot = (unsigned int)m_Slots.size();
+		m_Slots.push_back(Slot{ index, 0 });
+	}
+
+	m_X.push_back(x);
+	m_Y.push_back(y);
+	m_VelocityX.push_back(velocityX);
+	m_VelocityY.push_back(velocityY);
+	m_Radius.push_back(radius);
+	m_Red.push_back(color[0]);
+	m_Green.push_back(color[1]);
+	m_Blue.push_back(color[2]);
+	m_Alpha.push_back(color[3]);
+	m_DenseToSlot.push_back(slot);
+
+	EntityHandle entity;
+	entity.slot = slot;
+	entity.generation = m_Slots[slot].generation;
+	return entity;
+}
+
+bool Scene::Destroy(EntityHandle entity)
+{
+	if (!IsValid(entity))
+		return false;
+
+	// Swap and pop: the last entity takes the removed one's place in every array
+	const unsigned int index = m_Slots[entity.slot].index;
+	const unsigned int last = GetCount() - 1;
+	if (index != last)
+	{
+		ForEachArray([index, last](std::vector<float>& values) { values[index] = values[last]; });
+		m_DenseToSlot[index] = m_DenseToSlot[last];
+		m_Slots[m_DenseToSlot[index]].index = index;
+	}
+	ForEachArray([](std::vector<float>& values) { values.pop_back(); });
+	m_DenseToSlot.pop_back();
+
+	Slot& slot = m_Slots[entity.slot];
+	slot.generation++;
+	slot.index = m_FreeSlot;
+	m_FreeSlot = entity.slot;
+	return true;
+}
+
+void Scene::Integrate(float dt)
+{
+	// Separate arrays with no aliasing between them, so this vectorizes as written
+	const unsigned int count = GetCount();
+	float* x = m_X.data();
+	float* y = m_Y.data();
+	const float* velocityX = m_VelocityX.data();
+	const float* velocityY = m_VelocityY.data();
+
+	for (unsigned int i = 0; i < count; i++)
+		x[i] += velocityX[i] * dt;
+	for (unsigned int i = 0; i < count; i++)
+		y[i] += velocityY[i] * dt;
+}
+
+unsigned int Scene::WriteInstances(CircleInstance* out, unsigned int first, unsigned int count) const
+{
+	if (first >= GetCount())
+		return 0;
+	if (count > GetCount() - first)
+		count = GetCount() - first;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const unsigned int index = first + i;
+		CircleInstance& instance = out[i];
+		instance.x = m_X[index];
+		instance.y = m_Y[index];
+		instance.radius = m_Radius[index];
+		instance.color[0] = m_Red[index];
+		instance.color[1] = m_Green[index];
+		instance.color[2] = m_Blue[index];
+		instance.color[3] = m_Alpha[index];
+	}
+	return count;
+}
+
+unsigned int Scene::WriteInstances(CircleInstance* out, const unsigned int* slots, unsigned int count) const
+{
+	unsigned int written = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const unsigned int index = GetSlotIndex(slots[i]);
+		if (index == InvalidIndex)
+			continue;
+
+		CircleInstance& instance = out[written++];
+		instance.x = m_X[index];
+		instance.y = m_Y[index];
+		instance.radius = m_Radius[index];
+		instance.color[0] = m_Red[index];
+		instance.color[1] = m_Green[index];
+		instance.color[2] = m_Blue[index];
+		instance.color[3] = m_Alpha[index];
+	}
+	return written;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include<vector>
+
+struct CircleInstance;
+
+// Stable reference to an entity. The generation changes every time a slot is reused,
+// so a handle to a removed entity stays invalid even after its slot is taken again.
+struct EntityHandle
+{
+	unsigned int slot = 0xFFFFFFFF;
+	unsigned int generation = 0;
+};
+
+// Entities stored as structure-of-arrays: entity i lives at index i of every array, and
+// the arrays are always densely packed, so systems can stream over them with SIMD.
+// Removal moves the last entity into the hole, so dense indices are only valid until
+// the next Destroy(); hold on to handles instead.
+class Scene
+{
+private:
+	std::vector<float> m_X, m_Y;
+	std::vector<float> m_VelocityX, m_VelocityY;
+	std::vector<float> m_Radius;
+	std::vector<float> m_Red, m_Green, m_Blue, m_Alpha;
+	// Dense index -> slot, to fix up the slot of the entity moved by Destroy()
+	std::vector<unsigned int> m_DenseToSlot;
+
+	struct Slot
+	{
+		// Dense index while alive, next free slot while free
+		unsigned int index;
+		unsigned int generation;
+	};
+	std::vector<Slot> m_Slots;
+	unsigned int m_FreeSlot;
+
+public:
+	static const unsigned int InvalidIndex = 0xFFFFFFFF;
+
+	Scene();
+
+	void Reserve(unsigned int count);
+	void Clear();
+
+	EntityHandle Create(float x, float y, float radius, const float color[4], float velocityX = 0.0f, float velocityY = 0.0f);
+	// Returns false if the handle was already stale
+	bool Destroy(EntityHandle entity);
+
+	inline bool IsValid(EntityHandle entity) const
+	{
+		return entity.slot < m_Slots.size() && m_Slots[entity.slot].generation == entity.generation;
+	}
+	// Current dense index of a valid entity
+	inline unsigned int GetIndex(EntityHandle entity) const { return m_Slots[entity.slot].index; }
+	// Dense index of the entity in slot, or InvalidIndex if the slot is free; for slots
+	// stored without a generation, e.g. as acceleration structure user data
+	inline unsigned int GetSlotIndex(unsigned int slot) const
+	{
+		if (slot >= m_Slots.size())
+			return InvalidIndex;
+		const unsigned int index = m_Slots[slot].index;
+		return index < m_DenseToSlot.size() && m_DenseToSlot[index] == slot ? index : InvalidIndex;
+	}
+	inline EntityHandle GetHandle(unsigned int index) const
+	{
+		EntityHandle entity;
+		entity.slot = m_DenseToSlot[index];
+		entity.generation = m_Slots[entity.slot].generation;
+		return entity;
+	}
+
+	// x += vx * dt, y += vy * dt for every entity
+	void Integrate(float dt);
+
+	// Gathers entities [first, first + count) into Circle.shader instances, e.g. straight
+	// into a mapped instance buffer. Returns the number written.
+	unsigned int WriteInstances(CircleInstance* out, unsigned int first, unsigned int count) const;
+	// Gathers the live entities in the given slots, e.g. a culling result. Returns the number written.
+	unsigned int WriteInstances(CircleInstance* out, const unsigned int* slots, unsigned int count) const;
+
+	inline unsigned int GetCount() const { return (unsigned int)m_X.size(); }
+
+	inline float* GetX() { return m_X.data(); }
+	inline float* GetY() { return m_Y.data(); }
+	inline float* GetVelocityX() { return m_VelocityX.data(); }
+	inline float* GetVelocityY() { return m_VelocityY.data(); }
+	inline float* GetRadius() { return m_Radius.data(); }
+	inline float* GetRed() { return m_Red.data(); }
+	inline float* GetGreen() { return m_Green.data(); }
+	inline float* GetBlue() { return m_Blue.data(); }
+	inline float* GetAlpha() { return m_Alpha.data(); }
+
+	inline const float* GetX() const { return m_X.data(); }
+	inline const float* GetY() const { return m_Y.data(); }
+	inline const float* GetVelocityX() const { return m_VelocityX.data(); }
+	inline const float* GetVelocityY() const { return m_VelocityY.data(); }
+	inline const float* GetRadius() const { return m_Radius.data(); }
+	inline const float* GetRed() const { return m_Red.data(); }
+	inline const float* GetGreen() const { return m_Green.data(); }
+	inline const float* GetBlue() const { return m_Blue.data(); }
+	inline const float* GetAlpha() const { return m_Alpha.data(); }
+
+private:
+	// Applies op to every per-entity array
+	template<typename Op>
+	void ForEachArray(Op op)
+	{
+		op(m_X); op(m_Y);
+		op(m_VelocityX); op(m_VelocityY);
+		op(m_Radius);
+		op(m_Red); op(m_Green); op(m_Blue); op(m_Alpha);
+	}
+};
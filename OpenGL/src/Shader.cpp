@@ -6,27 +6,32 @@
 #include<string>
 
 #include "Renderer.h"
+#include "GLState.h"
 
 Shader::Shader(const std::string& filepath)
 	: m_FilePath(filepath), m_RenderedId(0)
 {
     ShaderProgramSource source = ParseShader(filepath);
-    m_RenderedId = CreateShader(source.VertexSource, source.FragmentSource);
+    if (!source.ComputeSource.empty())
+        m_RenderedId = CreateComputeShader(source.ComputeSource);
+    else
+        m_RenderedId = CreateShader(source.VertexSource, source.FragmentSource, source.FeedbackVaryings);
 }
 
 Shader::~Shader()
 {
+    GLState::Get().OnProgramDeleted(m_RenderedId);
     glDeleteProgram(m_RenderedId);
 }
 
 void Shader::Bind() const
 {
-    glUseProgram(m_RenderedId);
+    GLState::Get().UseProgram(m_RenderedId);
 }
 
 void Shader::Unbind() const
 {
-    glUseProgram(0);
+    GLState::Get().UseProgram(0);
 }
 
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
@@ -44,6 +49,16 @@ void Shader::SetUniform2f(const std::string& name, float v0, float v1)
     glUniform2f(GetUniformLocation(name), v0, v1);
 }
 
+void Shader::SetUniform1i(const std::string& name, int v0)
+{
+    glUniform1i(GetUniformLocation(name), v0);
+}
+
+void Shader::SetUniform1ui(const std::string& name, unsigned int v0)
+{
+    glUniform1ui(GetUniformLocation(name), v0);
+}
+
 unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 {
     unsigned int id = glCreateShader(type);
@@ -62,7 +77,8 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
         char* message = (char*)malloc(length * sizeof(char));
         glGetShaderInfoLog(id, length, &length, message);
 
-        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader!" << std::endl;
+        const char* stage = type == GL_VERTEX_SHADER ? "vertex" : (type == GL_FRAGMENT_SHADER ? "fragment" : "compute");
+        std::cout << "Failed to compile " << stage << " shader!" << std::endl;
         std::cout << message << std::endl;
 
         glDeleteShader(id);
@@ -76,18 +92,26 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
 {
     enum class ShaderType
     {
-        NONE = -1, VERTEX = 0, FRAGMENT = 1
+        NONE = -1, VERTEX = 0, FRAGMENT = 1, COMPUTE = 2
     };
 
     std::ifstream stream(filepath);
 
     std::string line;
-    std::stringstream ss[2];
+    std::stringstream ss[3];
+    std::vector<std::string> feedbackVaryings;
     ShaderType type = ShaderType::NONE;
 
     while (getline(stream, line))
     {
-        if (line.find("#shader") != std::string::npos)
+        if (line.find("#feedback") != std::string::npos)
+        {
+            std::stringstream names(line.substr(line.find("#feedback") + 9));
+            std::string name;
+            while (names >> name)
+                feedbackVaryings.push_back(name);
+        }
+        else if (line.find("#shader") != std::string::npos)
         {
             if (line.find("vertex") != std::string::npos)
             {
@@ -97,6 +121,10 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
             {
                 type = ShaderType::FRAGMENT;
             }
+            else if (line.find("compute") != std::string::npos)
+            {
+                type = ShaderType::COMPUTE;
+            }
         }
         else
         {
@@ -104,31 +132,85 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
         }
     }
 
-    return { ss[0].str(), ss[1].str() };
+    return { ss[0].str(), ss[1].str(), ss[2].str(), feedbackVaryings };
 }
 
-unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
+unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader, const std::vector<std::string>& feedbackVaryings)
 {
     unsigned int program = glCreateProgram();
     unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
-
     glAttachShader(program, vs);
-    glAttachShader(program, fs);
+
+    // A feedback-only program runs with rasterization discarded and needs no fragment stage
+    unsigned int fs = 0;
+    if (!fragmentShader.empty() || feedbackVaryings.empty())
+    {
+        fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+        glAttachShader(program, fs);
+    }
+
+    // Has to be set before linking
+    if (!feedbackVaryings.empty())
+    {
+        std::vector<const char*> names;
+        for (const std::string& name : feedbackVaryings)
+            names.push_back(name.c_str());
+        glTransformFeedbackVaryings(program, (GLsizei)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS);
+    }
 
     glLinkProgram(program);
     glValidateProgram(program);
 
     glDeleteShader(vs);
-    glDeleteShader(fs);
+    if (fs)
+        glDeleteShader(fs);
 
     return program;
 }
 
+unsigned int Shader::CreateComputeShader(const std::string& computeShader)
+{
+    unsigned int cs = CompileShader(GL_COMPUTE_SHADER, computeShader);
+    if (!cs)
+        return 0;
+
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, cs);
+    glLinkProgram(program);
+    glDeleteShader(cs);
+
+    // Callers fall back to the CPU when there is no program, so don't hand out a dead one
+    int result;
+    glGetProgramiv(program, GL_LINK_STATUS, &result);
+    if (result == GL_FALSE)
+    {
+        int length;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+
+        std::vector<char> message(length + 1);
+        glGetProgramInfoLog(program, length, &length, message.data());
+
+        std::cout << "Failed to link compute shader!" << std::endl;
+        std::cout << message.data() << std::endl;
+
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    glValidateProgram(program);
+    return program;
+}
+
 int Shader::GetUniformLocation(const std::string& name)
 {
+    auto it = m_UniformLocationCache.find(name);
+    if (it != m_UniformLocationCache.end())
+        return it->second;
+
     int location = glGetUniformLocation(m_RenderedId, name.c_str());
     if (location == -1)
-        //std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
+        std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
+
+    m_UniformLocationCache[name] = location;
     return location;
 }
@@ -1,11 +1,18 @@
 #pragma once
 
 #include<string>
+#include<unordered_map>
+#include<vector>
 
 struct ShaderProgramSource
 {
 	std::string VertexSource;
 	std::string FragmentSource;
+	// Set instead of the other two for a compute-only file
+	std::string ComputeSource;
+	// Vertex outputs captured by transform feedback, interleaved in this order, from a
+	// "#feedback name name ..." line; a program with these may leave out the fragment shader
+	std::vector<std::string> FeedbackVaryings;
 };
 
 class Shader
@@ -13,6 +20,7 @@ class Shader
 private:
 	std::string m_FilePath;
 	unsigned int m_RenderedId;
+	std::unordered_map<std::string, int> m_UniformLocationCache;
 
 public:
 	Shader(const std::string& filepath);
@@ -21,13 +29,20 @@ public:
 	void Bind() const;
 	void Unbind() const;
 
+	inline unsigned int GetRendererID() const { return m_RenderedId; }
+	// False if a compute shader failed to compile or link
+	inline bool IsValid() const { return m_RenderedId != 0; }
+
 	// Set uniforms
 	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
 	void SetUniform1f(const std::string& name, float f1);
 	void SetUniform2f(const std::string& name, float v0, float v1);
+	void SetUniform1i(const std::string& name, int v0);
+	void SetUniform1ui(const std::string& name, unsigned int v0);
 
 private:
-	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
+	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader, const std::vector<std::string>& feedbackVaryings);
+	unsigned int CreateComputeShader(const std::string& computeShader);
 	ShaderProgramSource ParseShader(const std::string& filepath);
 	unsigned int CompileShader(unsigned int type, const std::string& source);
 	int GetUniformLocation(const std::string& location);
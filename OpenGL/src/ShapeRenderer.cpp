@@ -0,0 +1,78 @@
+#include "ShapeRenderer.h"
+#include "GLState.h"
+
+static const float s_QuadPositions[] = {
+	-1.0f, -1.0f,
+	 1.0f, -1.0f,
+	 1.0f,  1.0f,
+	-1.0f,  1.0f
+};
+
+static const unsigned int s_QuadIndices[] = { 0, 1, 2, 2, 3, 0 };
+
+ShapeRenderer::ShapeRenderer(float viewportWidth, float viewportHeight, float maxPixelError)
+	: m_SdfShader("res/Shaders/SDF.shader"), m_CircleShader("res/Shaders/Circle.shader"),
+	m_QuadVertices(s_QuadPositions, sizeof(s_QuadPositions)), m_QuadIndices(s_QuadIndices, 6),
+	m_CircleInstance(nullptr, sizeof(CircleInstance)),
+	m_ViewportWidth(viewportWidth), m_ViewportHeight(viewportHeight), m_MaxPixelError(maxPixelError)
+{
+	VertexBufferLayout layout;
+	layout.Push<float>(2);
+	m_QuadArray.AddBuffer(m_QuadVertices, layout);
+	m_QuadArray.SetIndexBuffer(m_QuadIndices);
+
+	m_Circles.SetInstanceBuffer(m_CircleInstance);
+}
+
+void ShapeRenderer::SetViewport(float width, float height)
+{
+	m_ViewportWidth = width;
+	m_ViewportHeight = height;
+}
+
+void ShapeRenderer::Draw(const Shape& shape, ShapeRenderMode mode)
+{
+	if (mode == ShapeRenderMode::Tessellated && shape.type == ShapeType::Circle)
+		DrawTessellated(shape);
+	else
+		DrawSignedDistance(shape);
+}
+
+void ShapeRenderer::DrawSignedDistance(const Shape& shape)
+{
+	GLState& state = GLState::Get();
+	state.SetBlend(true);
+	state.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	float halfHeight = shape.type == ShapeType::RoundedRect ? shape.halfHeight : shape.halfWidth;
+
+	m_SdfShader.Bind();
+	m_SdfShader.SetUniform4f("u_Color", shape.color[0], shape.color[1], shape.color[2], shape.color[3]);
+	m_SdfShader.SetUniform2f("u_Offset", shape.x, shape.y);
+	m_SdfShader.SetUniform2f("u_Size", shape.halfWidth, halfHeight);
+	m_SdfShader.SetUniform2f("u_PixelSize", 2.0f / m_ViewportWidth, 2.0f / m_ViewportHeight);
+	m_SdfShader.SetUniform1i("u_Shape", (int)shape.type);
+	m_SdfShader.SetUniform1f("u_Thickness", shape.thickness);
+	m_SdfShader.SetUniform1f("u_CornerRadius", shape.cornerRadius);
+
+	m_QuadArray.Bind();
+	glDrawElements(GL_TRIANGLES, m_QuadIndices.GetCount(), GL_UNSIGNED_INT, nullptr);
+}
+
+void ShapeRenderer::DrawTessellated(const Shape& shape)
+{
+	GLState::Get().SetBlend(false);
+
+	CircleInstance instance;
+	instance.x = shape.x;
+	instance.y = shape.y;
+	instance.radius = shape.halfWidth;
+	for (unsigned int i = 0; i < 4; i++)
+		instance.color[i] = shape.color[i];
+	m_CircleInstance.SetData(&instance, sizeof(instance));
+
+	unsigned char level = SelectCircleLOD(GetProjectedRadius(shape.halfWidth, m_ViewportHeight), m_MaxPixelError, CIRCLE_LOD_NONE);
+
+	m_CircleShader.Bind();
+	m_Circles.Draw(level, m_CircleInstance, 0, 1);
+}
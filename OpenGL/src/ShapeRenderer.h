@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Shader.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "CircleLOD.h"
+
+enum class ShapeRenderMode
+{
+	// Triangle fan from CircleLODMeshes; circles only
+	Tessellated,
+	// One quad per shape, edge evaluated analytically in SDF.shader
+	SignedDistance
+};
+
+enum class ShapeType
+{
+	Circle = 0, Ring = 1, RoundedRect = 2
+};
+
+struct Shape
+{
+	ShapeType type = ShapeType::Circle;
+	float x = 0.0f, y = 0.0f;
+	// Circles and rings use halfWidth as the outer radius
+	float halfWidth = 0.1f, halfHeight = 0.1f;
+	float thickness = 0.02f;
+	float cornerRadius = 0.02f;
+	float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+};
+
+// Draws circles, rings and rounded rectangles one at a time, choosing per draw between
+// tessellated geometry and a single signed-distance quad (4 vertices instead of up to 258).
+class ShapeRenderer
+{
+private:
+	Shader m_SdfShader;
+	Shader m_CircleShader;
+
+	VertexBuffer m_QuadVertices;
+	IndexBuffer m_QuadIndices;
+	VertexArray m_QuadArray;
+
+	CircleLODMeshes m_Circles;
+	VertexBuffer m_CircleInstance;
+
+	float m_ViewportWidth, m_ViewportHeight;
+	float m_MaxPixelError;
+
+public:
+	ShapeRenderer(float viewportWidth, float viewportHeight, float maxPixelError = 0.5f);
+
+	void SetViewport(float width, float height);
+	// Shapes other than circles are always drawn as signed-distance quads
+	void Draw(const Shape& shape, ShapeRenderMode mode);
+
+private:
+	void DrawSignedDistance(const Shape& shape);
+	void DrawTessellated(const Shape& shape);
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+// Instruction set chosen at compile time. SIMD_AVX implies SIMD_SSE, so code can test
+// for the widest set first and fall through.
+#if defined(__AVX__)
+	#include<immintrin.h>
+	#define SIMD_AVX
+	#define SIMD_SSE
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include<emmintrin.h>
+	#define SIMD_SSE
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#include<arm_neon.h>
+	#define SIMD_NEON
+#endif
@@ -0,0 +1,113 @@
+#pragma once
+
+#include<cmath>
+
+#include "Simd.h"
+
+// Batch kernels are written once against these few operations, so each instruction
+// set only has to supply a handful of one-liners. MaskBits() packs lane i of a mask
+// into bit i. Only for .cpp files: everything here is file-local.
+#if defined(SIMD_AVX)
+	typedef __m256 Floats;
+	typedef __m256 Mask;
+	static const unsigned int WIDTH = 8;
+
+	static inline Floats Load(const float* p) { return _mm256_loadu_ps(p); }
+	static inline void Store(float* p, Floats v) { _mm256_storeu_ps(p, v); }
+	static inline Floats Set(float v) { return _mm256_set1_ps(v); }
+	static inline Floats Add(Floats a, Floats b) { return _mm256_add_ps(a, b); }
+	static inline Floats Sub(Floats a, Floats b) { return _mm256_sub_ps(a, b); }
+	static inline Floats Mul(Floats a, Floats b) { return _mm256_mul_ps(a, b); }
+	static inline Floats Abs(Floats v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+	static inline Floats Truncate(Floats v) { return _mm256_round_ps(v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+	static inline Mask Equal(Floats a, Floats b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+	static inline Mask GreaterEqual(Floats a, Floats b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	static inline Mask Less(Floats a, Floats b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static inline Mask LessEqual(Floats a, Floats b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+	static inline Mask And(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+	static inline Mask Or(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+	static inline Mask Xor(Mask a, Mask b) { return _mm256_xor_ps(a, b); }
+	static inline Floats Select(Mask mask, Floats a, Floats b) { return _mm256_or_ps(_mm256_and_ps(mask, a), _mm256_andnot_ps(mask, b)); }
+	static inline unsigned int MaskBits(Mask mask) { return (unsigned int)_mm256_movemask_ps(mask); }
+	// [x0 y0 x1 y1 ...] -> [x0 x0 x1 x1 ...] and [y0 y0 y1 y1 ...]
+	static inline Floats DuplicateEven(Floats v) { return _mm256_moveldup_ps(v); }
+	static inline Floats DuplicateOdd(Floats v) { return _mm256_movehdup_ps(v); }
+	static inline Floats SetPairs(float even, float odd) { return _mm256_setr_ps(even, odd, even, odd, even, odd, even, odd); }
+#elif defined(SIMD_SSE)
+	typedef __m128 Floats;
+	typedef __m128 Mask;
+	static const unsigned int WIDTH = 4;
+
+	static inline Floats Load(const float* p) { return _mm_loadu_ps(p); }
+	static inline void Store(float* p, Floats v) { _mm_storeu_ps(p, v); }
+	static inline Floats Set(float v) { return _mm_set1_ps(v); }
+	static inline Floats Add(Floats a, Floats b) { return _mm_add_ps(a, b); }
+	static inline Floats Sub(Floats a, Floats b) { return _mm_sub_ps(a, b); }
+	static inline Floats Mul(Floats a, Floats b) { return _mm_mul_ps(a, b); }
+	static inline Floats Abs(Floats v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+	// SSE2 has no round instruction; the kernels only truncate values well inside int range
+	static inline Floats Truncate(Floats v) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(v)); }
+	static inline Mask Equal(Floats a, Floats b) { return _mm_cmpeq_ps(a, b); }
+	static inline Mask GreaterEqual(Floats a, Floats b) { return _mm_cmpge_ps(a, b); }
+	static inline Mask Less(Floats a, Floats b) { return _mm_cmplt_ps(a, b); }
+	static inline Mask LessEqual(Floats a, Floats b) { return _mm_cmple_ps(a, b); }
+	static inline Mask And(Mask a, Mask b) { return _mm_and_ps(a, b); }
+	static inline Mask Or(Mask a, Mask b) { return _mm_or_ps(a, b); }
+	static inline Mask Xor(Mask a, Mask b) { return _mm_xor_ps(a, b); }
+	static inline Floats Select(Mask mask, Floats a, Floats b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	static inline unsigned int MaskBits(Mask mask) { return (unsigned int)_mm_movemask_ps(mask); }
+	static inline Floats DuplicateEven(Floats v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0)); }
+	static inline Floats DuplicateOdd(Floats v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 1, 1)); }
+	static inline Floats SetPairs(float even, float odd) { return _mm_setr_ps(even, odd, even, odd); }
+#elif defined(SIMD_NEON)
+	typedef float32x4_t Floats;
+	typedef uint32x4_t Mask;
+	static const unsigned int WIDTH = 4;
+
+	static inline Floats Load(const float* p) { return vld1q_f32(p); }
+	static inline void Store(float* p, Floats v) { vst1q_f32(p, v); }
+	static inline Floats Set(float v) { return vdupq_n_f32(v); }
+	static inline Floats Add(Floats a, Floats b) { return vaddq_f32(a, b); }
+	static inline Floats Sub(Floats a, Floats b) { return vsubq_f32(a, b); }
+	static inline Floats Mul(Floats a, Floats b) { return vmulq_f32(a, b); }
+	static inline Floats Abs(Floats v) { return vabsq_f32(v); }
+	static inline Floats Truncate(Floats v) { return vcvtq_f32_s32(vcvtq_s32_f32(v)); }
+	static inline Mask Equal(Floats a, Floats b) { return vceqq_f32(a, b); }
+	static inline Mask GreaterEqual(Floats a, Floats b) { return vcgeq_f32(a, b); }
+	static inline Mask Less(Floats a, Floats b) { return vcltq_f32(a, b); }
+	static inline Mask LessEqual(Floats a, Floats b) { return vcleq_f32(a, b); }
+	static inline Mask And(Mask a, Mask b) { return vandq_u32(a, b); }
+	static inline Mask Or(Mask a, Mask b) { return vorrq_u32(a, b); }
+	static inline Mask Xor(Mask a, Mask b) { return veorq_u32(a, b); }
+	static inline Floats Select(Mask mask, Floats a, Floats b) { return vbslq_f32(mask, a, b); }
+	static inline unsigned int MaskBits(Mask mask)
+	{
+		const int32x4_t shift = { 0, 1, 2, 3 };
+		return vaddvq_u32(vshlq_u32(vshrq_n_u32(mask, 31), shift));
+	}
+	static inline Floats DuplicateEven(Floats v) { return vtrnq_f32(v, v).val[0]; }
+	static inline Floats DuplicateOdd(Floats v) { return vtrnq_f32(v, v).val[1]; }
+	static inline Floats SetPairs(float even, float odd) { const float pair[4] = { even, odd, even, odd }; return vld1q_f32(pair); }
+#else
+	typedef float Floats;
+	typedef bool Mask;
+	static const unsigned int WIDTH = 1;
+
+	static inline Floats Load(const float* p) { return *p; }
+	static inline void Store(float* p, Floats v) { *p = v; }
+	static inline Floats Set(float v) { return v; }
+	static inline Floats Add(Floats a, Floats b) { return a + b; }
+	static inline Floats Sub(Floats a, Floats b) { return a - b; }
+	static inline Floats Mul(Floats a, Floats b) { return a * b; }
+	static inline Floats Abs(Floats v) { return std::fabs(v); }
+	static inline Floats Truncate(Floats v) { return (float)(int)v; }
+	static inline Mask Equal(Floats a, Floats b) { return a == b; }
+	static inline Mask GreaterEqual(Floats a, Floats b) { return a >= b; }
+	static inline Mask Less(Floats a, Floats b) { return a < b; }
+	static inline Mask LessEqual(Floats a, Floats b) { return a <= b; }
+	static inline Mask And(Mask a, Mask b) { return a && b; }
+	static inline Mask Or(Mask a, Mask b) { return a || b; }
+	static inline Mask Xor(Mask a, Mask b) { return a != b; }
+	static inline Floats Select(Mask mask, Floats a, Floats b) { return mask ? a : b; }
+	static inline unsigned int MaskBits(Mask mask) { return mask ? 1u : 0u; }
+#endif
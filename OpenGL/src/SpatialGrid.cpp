@@ -0,0 +1,254 @@
+#include "SpatialGrid.h"
+#include "JobSystem.h"
+
+#include<atomic>
+#include<cmath>
+
+const unsigned int NO_BUCKET = 0xFFFFFFFF;
+
+SpatialGrid::SpatialGrid(float cellSize, unsigned int bucketCount)
+	: m_CellSize(cellSize), m_InverseCellSize(1.0f / cellSize), m_MaxRadius(0.0f), m_Count(0)
+{
+	unsigned int buckets = 1;
+	while (buckets < bucketCount)
+		buckets <<= 1;
+	m_BucketMask = buckets - 1;
+	m_Buckets.resize(buckets);
+}
+
+void SpatialGrid::Clear()
+{
+	for (auto& bucket : m_Buckets)
+		bucket.clear();
+	m_Locations.clear();
+	m_MaxRadius = 0.0f;
+	m_Count = 0;
+}
+
+int SpatialGrid::GetCell(float v) const
+{
+	return (int)std::floor(v * m_InverseCellSize);
+}
+
+unsigned int SpatialGrid::GetBucket(int cellX, int cellY) const
+{
+	return ((unsigned int)cellX * 73856093u ^ (unsigned int)cellY * 19349663u) & m_BucketMask;
+}
+
+bool SpatialGrid::Contains(EntityHandle entity) const
+{
+	return entity.slot < m_Locations.size() && m_Locations[entity.slot].bucket != NO_BUCKET &&
+		m_Locations[entity.slot].generation == entity.generation;
+}
+
+void SpatialGrid::Insert(EntityHandle entity, float x, float y, float radius)
+{
+	if (Contains(entity))
+	{
+		Move(entity, x, y, radius);
+		return;
+	}
+
+	if (entity.slot >= m_Locations.size())
+		m_Locations.resize(entity.slot + 1, Location{ NO_BUCKET, 0, 0 });
+
+	const unsigned int bucket = GetBucket(GetCell(x), GetCell(y));
+	m_Locations[entity.slot] = Location{ bucket, (unsigned int)m_Buckets[bucket].size(), entity.generation };
+	m_Buckets[bucket].push_back(Entry{ entity, x, y, radius });
+
+	if (radius > m_MaxRadius)
+		m_MaxRadius = radius;
+	m_Count++;
+}
+
+void SpatialGrid::Move(EntityHandle entity, float x, float y, float radius)
+{
+	if (!Contains(entity))
+		return;
+
+	const Location& location = m_Locations[entity.slot];
+	if (GetBucket(GetCell(x), GetCell(y)) != location.bucket)
+	{
+		Remove(entity);
+		Insert(entity, x, y, radius);
+		return;
+	}
+
+	Entry& entry = m_Buckets[location.bucket][location.index];
+	entry.x = x;
+	entry.y = y;
+	entry.radius = radius;
+	if (radius > m_MaxRadius)
+		m_MaxRadius = radius;
+}
+
+void SpatialGrid::Remove(EntityHandle entity)
+{
+	if (!Contains(entity))
+		return;
+
+	// Swap and pop within the bucket
+	Location& location = m_Locations[entity.slot];
+	std::vector<Entry>& bucket = m_Buckets[location.bucket];
+	if (location.index != bucket.size() - 1)
+	{
+		bucket[location.index] = bucket.back();
+		m_Locations[bucket[location.index].entity.slot].index = location.index;
+	}
+	bucket.pop_back();
+
+	location.bucket = NO_BUCKET;
+	m_Count--;
+}
+
+void SpatialGrid::Update(const Scene& scene)
+{
+	const float* x = scene.GetX();
+	const float* y = scene.GetY();
+	const float* radius = scene.GetRadius();
+
+	for (unsigned int i = 0; i < scene.GetCount(); i++)
+		Move(scene.GetHandle(i), x[i], y[i], radius[i]);
+}
+
+void SpatialGrid::Rebuild(JobSystem& jobs, const Scene& scene)
+{
+	Clear();
+
+	const unsigned int count = scene.GetCount();
+	const float* x = scene.GetX();
+	const float* y = scene.GetY();
+	const float* radius = scene.GetRadius();
+
+	// Counting sort into the buckets: size every bucket, then scatter with a cursor per bucket
+	std::vector<EntityHandle> entities(count);
+	std::vector<unsigned int> buckets(count);
+	std::vector<std::atomic<unsigned int>> cursors(m_Buckets.size());
+	for (auto& cursor : cursors)
+		cursor.store(0, std::memory_order_relaxed);
+
+	const unsigned int chunkSize = 4096;
+	const unsigned int chunks = (count + chunkSize - 1) / chunkSize;
+	std::vector<float> chunkMaxRadius(chunks, 0.0f);
+	std::vector<unsigned int> chunkMaxSlot(chunks, 0);
+
+	jobs.ParallelFor(count, chunkSize, [&](unsigned int begin, unsigned int end)
+	{
+		float maxRadius = 0.0f;
+		unsigned int maxSlot = 0;
+		for (unsigned int i = begin; i < end; i++)
+		{
+			entities[i] = scene.GetHandle(i);
+			buckets[i] = GetBucket(GetCell(x[i]), GetCell(y[i]));
+			cursors[buckets[i]].fetch_add(1, std::memory_order_relaxed);
+			maxRadius = radius[i] > maxRadius ? radius[i] : maxRadius;
+			maxSlot = entities[i].slot > maxSlot ? entities[i].slot : maxSlot;
+		}
+		chunkMaxRadius[begin / chunkSize] = maxRadius;
+		chunkMaxSlot[begin / chunkSize] = maxSlot;
+	});
+
+	unsigned int maxSlot = 0;
+	for (unsigned int c = 0; c < chunks; c++)
+	{
+		m_MaxRadius = chunkMaxRadius[c] > m_MaxRadius ? chunkMaxRadius[c] : m_MaxRadius;
+		maxSlot = chunkMaxSlot[c] > maxSlot ? chunkMaxSlot[c] : maxSlot;
+	}
+	if (count > 0)
+		m_Locations.resize(maxSlot + 1, Location{ NO_BUCKET, 0, 0 });
+
+	jobs.ParallelFor((unsigned int)m_Buckets.size(), 0, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int b = begin; b < end; b++)
+		{
+			m_Buckets[b].resize(cursors[b].load(std::memory_order_relaxed));
+			cursors[b].store(0, std::memory_order_relaxed);
+		}
+	});
+
+	jobs.ParallelFor(count, chunkSize, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; i++)
+		{
+			const unsigned int bucket = buckets[i];
+			const unsigned int index = cursors[bucket].fetch_add(1, std::memory_order_relaxed);
+			m_Buckets[bucket][index] = Entry{ entities[i], x[i], y[i], radius[i] };
+			m_Locations[entities[i].slot] = Location{ bucket, index, entities[i].generation };
+		}
+	});
+
+	m_Count = count;
+}
+
+template<typename Visit>
+void SpatialGrid::ForEachCandidate(float minX, float minY, float maxX, float maxY, Visit visit) const
+{
+	const int firstX = GetCell(minX - m_MaxRadius), lastX = GetCell(maxX + m_MaxRadius);
+	const int firstY = GetCell(minY - m_MaxRadius), lastY = GetCell(maxY + m_MaxRadius);
+
+	// A box covering more cells than there are buckets visits every bucket anyway
+	if ((double)(lastX - firstX + 1) * (lastY - firstY + 1) > m_Buckets.size())
+	{
+		for (const auto& bucket : m_Buckets)
+			for (const Entry& entry : bucket)
+			{
+				int cellX = GetCell(entry.x), cellY = GetCell(entry.y);
+				if (cellX >= firstX && cellX <= lastX && cellY >= firstY && cellY <= lastY)
+					visit(entry);
+			}
+		return;
+	}
+
+	for (int cellY = firstY; cellY <= lastY; cellY++)
+		for (int cellX = firstX; cellX <= lastX; cellX++)
+			for (const Entry& entry : m_Buckets[GetBucket(cellX, cellY)])
+			{
+				// Other cells hash to the same bucket; skip them so nothing is visited twice
+				if (GetCell(entry.x) == cellX && GetCell(entry.y) == cellY)
+					visit(entry);
+			}
+}
+
+EntityHandle SpatialGrid::Pick(const Scene& scene, float x, float y) const
+{
+	EntityHandle picked;
+	unsigned int pickedIndex = 0;
+
+	ForEachCandidate(x, y, x, y, [&](const Entry& entry)
+	{
+		float dx = x - entry.x, dy = y - entry.y;
+		if (dx * dx + dy * dy > entry.radius * entry.radius || !scene.IsValid(entry.entity))
+			return;
+
+		unsigned int index = scene.GetIndex(entry.entity);
+		if (picked.slot == 0xFFFFFFFF || index > pickedIndex)
+		{
+			picked = entry.entity;
+			pickedIndex = index;
+		}
+	});
+
+	return picked;
+}
+
+void SpatialGrid::QueryRadius(float x, float y, float radius, std::vector<EntityHandle>& out) const
+{
+	ForEachCandidate(x - radius, y - radius, x + radius, y + radius, [&](const Entry& entry)
+	{
+		float dx = x - entry.x, dy = y - entry.y, reach = radius + entry.radius;
+		if (dx * dx + dy * dy <= reach * reach)
+			out.push_back(entry.entity);
+	});
+}
+
+void SpatialGrid::QueryRect(float minX, float minY, float maxX, float maxY, std::vector<EntityHandle>& out) const
+{
+	ForEachCandidate(minX, minY, maxX, maxY, [&](const Entry& entry)
+	{
+		// Distance from the center to the nearest point of the rectangle
+		float dx = entry.x < minX ? minX - entry.x : (entry.x > maxX ? entry.x - maxX : 0.0f);
+		float dy = entry.y < minY ? minY - entry.y : (entry.y > maxY ? entry.y - maxY : 0.0f);
+		if (dx * dx + dy * dy <= entry.radius * entry.radius)
+			out.push_back(entry.entity);
+	});
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include<vector>
+
+#include "Scene.h"
+
+class JobSystem;
+
+// Loose uniform grid over circles, hashed into a fixed number of buckets so the world
+// needs no bounds. Each circle is stored once, in the cell holding its center; queries
+// widen their search by the largest radius seen so circles overlapping a cell edge
+// are still found. Coordinates are the normalized ones the mouse callback produces.
+class SpatialGrid
+{
+private:
+	struct Entry
+	{
+		EntityHandle entity;
+		float x, y, radius;
+	};
+
+	// Where an entity's entry lives, indexed by EntityHandle::slot
+	struct Location
+	{
+		unsigned int bucket;
+		unsigned int index;
+		unsigned int generation;
+	};
+
+	float m_CellSize;
+	float m_InverseCellSize;
+	float m_MaxRadius;
+	unsigned int m_BucketMask;
+	std::vector<std::vector<Entry>> m_Buckets;
+	std::vector<Location> m_Locations;
+	unsigned int m_Count;
+
+public:
+	// cellSize around twice the typical radius works well; bucketCount is rounded up to a power of two
+	explicit SpatialGrid(float cellSize = 0.05f, unsigned int bucketCount = 65536);
+
+	void Clear();
+
+	void Insert(EntityHandle entity, float x, float y, float radius);
+	// Moves an entry to another bucket only when its center changes cell
+	void Move(EntityHandle entity, float x, float y, float radius);
+	void Remove(EntityHandle entity);
+	// Moves every entity of the scene that is already in the grid
+	void Update(const Scene& scene);
+	// Drops everything and inserts every entity of the scene, in parallel
+	void Rebuild(JobSystem& jobs, const Scene& scene);
+
+	// Topmost circle containing the point: the one drawn last, i.e. with the highest
+	// index in the scene. Returns an invalid handle if there is none.
+	EntityHandle Pick(const Scene& scene, float x, float y) const;
+	// Circles overlapping the disc, or the rectangle, in no particular order
+	void QueryRadius(float x, float y, float radius, std::vector<EntityHandle>& out) const;
+	void QueryRect(float minX, float minY, float maxX, float maxY, std::vector<EntityHandle>& out) const;
+
+	inline unsigned int GetCount() const { return m_Count; }
+	inline float GetCellSize() const { return m_CellSize; }
+
+private:
+	int GetCell(float v) const;
+	unsigned int GetBucket(int cellX, int cellY) const;
+	bool Contains(EntityHandle entity) const;
+
+	// Calls visit(entry) once for every entry whose cell overlaps the box widened by m_MaxRadius
+	template<typename Visit>
+	void ForEachCandidate(float minX, float minY, float maxX, float maxY, Visit visit) const;
+};
@@ -0,0 +1,118 @@
+#include "Tessellator.h"
+#include "Simd.h"
+
+#include<cmath>
+#include<memory>
+#include<mutex>
+#include<unordered_map>
+
+static const double PI = 3.14159265358979323846;
+
+static std::mutex s_TableMutex;
+static std::unordered_map<unsigned int, std::unique_ptr<ArcTable>> s_CircleTables;
+
+static void FillTable(ArcTable& table, unsigned int segments, double start, double end)
+{
+	table.points = segments + 1;
+	table.cos.resize(table.points);
+	table.sin.resize(table.points);
+
+	// Evaluated once per table in double precision, so the rim closes exactly
+	const double step = (end - start) / segments;
+	for (unsigned int i = 0; i < table.points; i++)
+	{
+		double angle = start + step * i;
+		table.cos[i] = (float)std::cos(angle);
+		table.sin[i] = (float)std::sin(angle);
+	}
+}
+
+const ArcTable& GetUnitCircleTable(unsigned int segments)
+{
+	std::lock_guard<std::mutex> lock(s_TableMutex);
+
+	std::unique_ptr<ArcTable>& table = s_CircleTables[segments];
+	if (!table)
+	{
+		table.reset(new ArcTable());
+		FillTable(*table, segments, 0.0, 2.0 * PI);
+		table->cos[segments] = table->cos[0];
+		table->sin[segments] = table->sin[0];
+	}
+	return *table;
+}
+
+void BuildArcTable(ArcTable& table, unsigned int segments, float startAngle, float endAngle)
+{
+	FillTable(table, segments, startAngle, endAngle);
+}
+
+void TessellateTable(float* out, const ArcTable& table, float cx, float cy, float rx, float ry)
+{
+	const float* c = table.cos.data();
+	const float* s = table.sin.data();
+	const unsigned int n = table.points;
+	unsigned int i = 0;
+
+#if defined(SIMD_AVX)
+	const __m256 vcx = _mm256_set1_ps(cx), vcy = _mm256_set1_ps(cy);
+	const __m256 vrx = _mm256_set1_ps(rx), vry = _mm256_set1_ps(ry);
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256 x = _mm256_add_ps(vcx, _mm256_mul_ps(vrx, _mm256_loadu_ps(c + i)));
+		__m256 y = _mm256_add_ps(vcy, _mm256_mul_ps(vry, _mm256_loadu_ps(s + i)));
+		// unpack works within 128-bit lanes, permute puts the halves back in order
+		__m256 lo = _mm256_unpacklo_ps(x, y);
+		__m256 hi = _mm256_unpackhi_ps(x, y);
+		_mm256_storeu_ps(out + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+		_mm256_storeu_ps(out + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+	}
+#elif defined(SIMD_SSE)
+	const __m128 vcx = _mm_set1_ps(cx), vcy = _mm_set1_ps(cy);
+	const __m128 vrx = _mm_set1_ps(rx), vry = _mm_set1_ps(ry);
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 x = _mm_add_ps(vcx, _mm_mul_ps(vrx, _mm_loadu_ps(c + i)));
+		__m128 y = _mm_add_ps(vcy, _mm_mul_ps(vry, _mm_loadu_ps(s + i)));
+		_mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(x, y));
+		_mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(x, y));
+	}
+#elif defined(SIMD_NEON)
+	const float32x4_t vcx = vdupq_n_f32(cx), vcy = vdupq_n_f32(cy);
+	for (; i + 4 <= n; i += 4)
+	{
+		float32x4x2_t xy;
+		xy.val[0] = vmlaq_n_f32(vcx, vld1q_f32(c + i), rx);
+		xy.val[1] = vmlaq_n_f32(vcy, vld1q_f32(s + i), ry);
+		vst2q_f32(out + 2 * i, xy);
+	}
+#endif
+
+	for (; i < n; i++)
+	{
+		out[2 * i] = cx + rx * c[i];
+		out[2 * i + 1] = cy + ry * s[i];
+	}
+}
+
+void TessellateCircle(float* out, float cx, float cy, float radius, unsigned int segments)
+{
+	TessellateEllipse(out, cx, cy, radius, radius, segments);
+}
+
+void TessellateEllipse(float* out, float cx, float cy, float rx, float ry, unsigned int segments)
+{
+	out[0] = cx;
+	out[1] = cy;
+	TessellateTable(out + 2, GetUnitCircleTable(segments), cx, cy, rx, ry);
+}
+
+void TessellateArc(float* out, float cx, float cy, float radius, float startAngle, float endAngle, unsigned int segments)
+{
+	out[0] = cx;
+	out[1] = cy;
+	// Per thread, so repeated arcs allocate nothing once it has grown
+	static thread_local ArcTable table;
+	BuildArcTable(table, segments, startAngle, endAngle);
+	TessellateTable(out + 2, table, cx, cy, radius, radius);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include<vector>
+
+// cos/sin of each point along a unit arc, stored as separate arrays so the
+// tessellation kernels can load four or eight points at once.
+struct ArcTable
+{
+	std::vector<float> cos;
+	std::vector<float> sin;
+	unsigned int points;
+};
+
+// Cached per segment count; safe to call from any thread. The returned tables live until
+// the program exits.
+const ArcTable& GetUnitCircleTable(unsigned int segments);
+// Arcs are not cached, since an animated sweep would add a table every frame. This fills
+// a caller-owned table, reusing its storage.
+void BuildArcTable(ArcTable& table, unsigned int segments, float startAngle, float endAngle);
+
+enum class ShapeKind : unsigned char
+{
+	Circle, Ellipse, Arc
+};
+
+// Shapes are written as a fan: the center followed by segments + 1 rim points, the
+// last one repeating the first for closed shapes. Output is interleaved x, y.
+inline unsigned int GetCircleVertexCount(unsigned int segments) { return segments + 2; }
+
+void TessellateCircle(float* out, float cx, float cy, float radius, unsigned int segments);
+void TessellateEllipse(float* out, float cx, float cy, float rx, float ry, unsigned int segments);
+// Angles in radians, counter-clockwise from +x
+void TessellateArc(float* out, float cx, float cy, float radius, float startAngle, float endAngle, unsigned int segments);
+
+// Rim points only: out[i] = (cx + rx * cos[i], cy + ry * sin[i]). Lets bulk callers
+// look the table up once instead of once per shape.
+void TessellateTable(float* out, const ArcTable& table, float cx, float cy, float rx, float ry);
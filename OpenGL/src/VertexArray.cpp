@@ -1,23 +1,57 @@
 #include "VertexArray.h"
 #include "VertexBufferLayout.h"
+#include "GLState.h"
 
 VertexArray::VertexArray()
+	: m_InstanceFirstAttrib(0)
 {
-	glGenVertexArrays(1, &m_RendererId);
-	glBindVertexArray(m_RendererId);
+	if (GLGetCapabilities().DirectStateAccess)
+		glCreateVertexArrays(1, &m_RendererId);
+	else
+		glGenVertexArrays(1, &m_RendererId);
+}
+
+VertexArray::VertexArray(const VertexBufferLayout& layout)
+	: m_Layout(layout), m_InstanceFirstAttrib(0)
+{
+	if (GLGetCapabilities().DirectStateAccess)
+		glCreateVertexArrays(1, &m_RendererId);
+	else
+		glGenVertexArrays(1, &m_RendererId);
+
+	SetFormat();
 }
 
 VertexArray::~VertexArray()
 {
+	GLState::Get().OnVertexArrayDeleted(m_RendererId);
 	glDeleteVertexArrays(1, &m_RendererId);
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
 {
+	const auto& elements = layout.GetElements();
+
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		const unsigned int binding = 0;
+		glVertexArrayVertexBuffer(m_RendererId, binding, vb.GetRendererID(), 0, layout.GetStride());
+
+		unsigned int offset = 0;
+		for (unsigned int i = 0; i < elements.size(); i++)
+		{
+			const auto& element = elements[i];
+			glEnableVertexArrayAttrib(m_RendererId, i);
+			glVertexArrayAttribFormat(m_RendererId, i, element.count, element.type, element.normalized, offset);
+			glVertexArrayAttribBinding(m_RendererId, i, binding);
+			offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+		}
+		return;
+	}
+
 	Bind();
 	vb.Bind();
-	const auto& elements = layout.GetElements();
-	unsigned int offset = 0;
+	uintptr_t offset = 0;
 	for (unsigned int i = 0; i < elements.size(); i++)
 	{
 		const auto& element = elements[i];
@@ -27,12 +61,145 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 	}
 }
 
+void VertexArray::SetIndexBuffer(const IndexBuffer& ib)
+{
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		glVertexArrayElementBuffer(m_RendererId, ib.GetRendererID());
+		GLState::Get().OnElementBufferAttached(m_RendererId, ib.GetRendererID());
+		return;
+	}
+
+	// The element array binding is part of the vertex array's state
+	Bind();
+	ib.Bind();
+}
+
+void VertexArray::AddInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttrib)
+{
+	m_InstanceLayout = layout;
+	m_InstanceFirstAttrib = firstAttrib;
+
+	const auto& elements = layout.GetElements();
+
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		const unsigned int binding = 1;
+		glVertexArrayVertexBuffer(m_RendererId, binding, vb.GetRendererID(), 0, layout.GetStride());
+		glVertexArrayBindingDivisor(m_RendererId, binding, 1);
+
+		unsigned int offset = 0;
+		for (unsigned int i = 0; i < elements.size(); i++)
+		{
+			const auto& element = elements[i];
+			glEnableVertexArrayAttrib(m_RendererId, firstAttrib + i);
+			glVertexArrayAttribFormat(m_RendererId, firstAttrib + i, element.count, element.type, element.normalized, offset);
+			glVertexArrayAttribBinding(m_RendererId, firstAttrib + i, binding);
+			offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+		}
+		return;
+	}
+
+	Bind();
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		glEnableVertexAttribArray(firstAttrib + i);
+		glVertexAttribDivisor(firstAttrib + i, 1);
+	}
+	BindInstanceBuffer(vb, 0);
+}
+
+void VertexArray::BindInstanceBuffer(const VertexBuffer& vb, unsigned int offset) const
+{
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		glVertexArrayVertexBuffer(m_RendererId, 1, vb.GetRendererID(), offset, m_InstanceLayout.GetStride());
+		return;
+	}
+
+	const auto& elements = m_InstanceLayout.GetElements();
+	vb.Bind();
+	uintptr_t elementOffset = offset;
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		const auto& element = elements[i];
+		glVertexAttribPointer(m_InstanceFirstAttrib + i, element.count, element.type, element.normalized, m_InstanceLayout.GetStride(), (const void*)elementOffset);
+		elementOffset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+	}
+}
+
+void VertexArray::SetFormat()
+{
+	const auto& elements = m_Layout.GetElements();
+	const unsigned int binding = 0;
+
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		unsigned int offset = 0;
+		for (unsigned int i = 0; i < elements.size(); i++)
+		{
+			const auto& element = elements[i];
+			glEnableVertexArrayAttrib(m_RendererId, i);
+			glVertexArrayAttribFormat(m_RendererId, i, element.count, element.type, element.normalized, offset);
+			glVertexArrayAttribBinding(m_RendererId, i, binding);
+			offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+		}
+		return;
+	}
+
+	Bind();
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		glEnableVertexAttribArray(i);
+	}
+
+	// Without ARB_vertex_attrib_binding the format is re-specified with the buffer in BindVertexBuffer
+	if (GLGetCapabilities().VertexAttribBinding)
+	{
+		unsigned int offset = 0;
+		for (unsigned int i = 0; i < elements.size(); i++)
+		{
+			const auto& element = elements[i];
+			glVertexAttribFormat(i, element.count, element.type, element.normalized, offset);
+			glVertexAttribBinding(i, binding);
+			offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+		}
+	}
+}
+
+void VertexArray::BindVertexBuffer(const VertexBuffer& vb, unsigned int offset) const
+{
+	const unsigned int binding = 0;
+
+	if (GLGetCapabilities().DirectStateAccess)
+	{
+		glVertexArrayVertexBuffer(m_RendererId, binding, vb.GetRendererID(), offset, m_Layout.GetStride());
+		return;
+	}
+
+	if (GLGetCapabilities().VertexAttribBinding)
+	{
+		glBindVertexBuffer(binding, vb.GetRendererID(), offset, m_Layout.GetStride());
+		return;
+	}
+
+	const auto& elements = m_Layout.GetElements();
+	vb.Bind();
+	uintptr_t elementOffset = offset;
+	for (unsigned int i = 0; i < elements.size(); i++)
+	{
+		const auto& element = elements[i];
+		glVertexAttribPointer(i, element.count, element.type, element.normalized, m_Layout.GetStride(), (const void*)elementOffset);
+		elementOffset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+	}
+}
+
 void VertexArray::Bind() const
 {
-	glBindVertexArray(m_RendererId);
+	GLState::Get().BindVertexArray(m_RendererId);
 }
 
 void VertexArray::Unbind() const
 {
-	glBindVertexArray(0);
-}
\ No newline at end of file
+	GLState::Get().BindVertexArray(0);
+}
@@ -1,17 +1,36 @@
 #pragma once
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
+#include "IndexBuffer.h"
 
 class VertexArray
 {
 private:
 	unsigned int m_RendererId;
+	VertexBufferLayout m_Layout;
+	VertexBufferLayout m_InstanceLayout;
+	unsigned int m_InstanceFirstAttrib;
 
 public:
 	VertexArray();
+	// Describes only the vertex format; buffers are attached per draw with BindVertexBuffer
+	explicit VertexArray(const VertexBufferLayout& layout);
 	~VertexArray();
 
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	void SetIndexBuffer(const IndexBuffer& ib);
+	// Per-instance attributes starting at location firstAttrib, advancing once per instance
+	void AddInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttrib);
+	// Points the instance attributes at offset bytes into vb. Bind() the vertex array first.
+	void BindInstanceBuffer(const VertexBuffer& vb, unsigned int offset) const;
+	// Swaps the buffer feeding the format given at construction. Bind() the vertex array first.
+	void BindVertexBuffer(const VertexBuffer& vb, unsigned int offset = 0) const;
 	void Bind() const;
 	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererId; }
+	inline const VertexBufferLayout& GetLayout() const { return m_Layout; }
+
+private:
+	void SetFormat();
 };
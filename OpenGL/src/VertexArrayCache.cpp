@@ -0,0 +1,15 @@
+#include "VertexArrayCache.h"
+
+VertexArray& VertexArrayCache::Get(const VertexBufferLayout& layout)
+{
+	auto& bucket = m_VertexArrays[layout.GetHash()];
+	for (const auto& va : bucket)
+	{
+		if (va->GetLayout() == layout)
+			return *va;
+	}
+
+	bucket.push_back(std::unique_ptr<VertexArray>(new VertexArray(layout)));
+	m_Count++;
+	return *bucket.back();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include<memory>
+#include<unordered_map>
+#include<vector>
+
+#include "VertexArray.h"
+
+// Shares one vertex array between every mesh with the same VertexBufferLayout.
+// Meshes bind their own buffers per draw through VertexArray::BindVertexBuffer.
+class VertexArrayCache
+{
+private:
+	std::unordered_map<size_t, std::vector<std::unique_ptr<VertexArray>>> m_VertexArrays;
+	unsigned int m_Count = 0;
+
+public:
+	VertexArray& Get(const VertexBufferLayout& layout);
+
+	inline unsigned int GetCount() const { return m_Count; }
+};
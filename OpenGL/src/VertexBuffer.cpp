@@ -1,25 +1,94 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "GLState.h"
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
 {
-    glGenBuffers(1, &m_RendererID);
-    glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
-    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    if (GLGetCapabilities().DirectStateAccess)
+    {
+        glCreateBuffers(1, &m_RendererID);
+        glNamedBufferData(m_RendererID, size, data, GL_STATIC_DRAW);
+    }
+    else
+    {
+        glGenBuffers(1, &m_RendererID);
+        GLState::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    }
 }
 
-VertexBuffer::~VertexBuffer()
+VertexBuffer::VertexBuffer(unsigned int size)
 {
+    if (GLGetCapabilities().DirectStateAccess)
+    {
+        glCreateBuffers(1, &m_RendererID);
+        glNamedBufferData(m_RendererID, size, nullptr, GL_DYNAMIC_DRAW);
+    }
+    else
+    {
+        glGenBuffers(1, &m_RendererID);
+        GLState::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    }
+}
 
+VertexBuffer::~VertexBuffer()
+{
+    GLState::Get().OnBufferDeleted(m_RendererID);
     glDeleteBuffers(1, &m_RendererID);
 }
 
+void VertexBuffer::SetData(const void* data, unsigned int size)
+{
+    if (GLGetCapabilities().DirectStateAccess)
+    {
+        glNamedBufferData(m_RendererID, size, data, GL_DYNAMIC_DRAW);
+    }
+    else
+    {
+        GLState::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW);
+    }
+}
+
+void* VertexBuffer::Map(unsigned int offset, unsigned int length)
+{
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+
+    if (GLGetCapabilities().DirectStateAccess)
+        return glMapNamedBufferRange(m_RendererID, offset, length, access);
+
+    GLState::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    return glMapBufferRange(GL_ARRAY_BUFFER, offset, length, access);
+}
+
+void VertexBuffer::FlushMappedRange(unsigned int offset, unsigned int length)
+{
+    if (GLGetCapabilities().DirectStateAccess)
+    {
+        glFlushMappedNamedBufferRange(m_RendererID, offset, length);
+        return;
+    }
+
+    GLState::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    glFlushMappedBufferRange(GL_ARRAY_BUFFER, offset, length);
+}
+
+bool VertexBuffer::Unmap()
+{
+    if (GLGetCapabilities().DirectStateAccess)
+        return glUnmapNamedBuffer(m_RendererID) == GL_TRUE;
+
+    GLState::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    return glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+}
+
 void VertexBuffer::Bind() const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    GLState::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 }
 
 void VertexBuffer::Unbind() const
 {
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
 }
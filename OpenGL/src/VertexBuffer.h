@@ -7,8 +7,23 @@ private:
 
 public:
 	VertexBuffer(const void* data, unsigned int size);
+	// Uninitialized store meant to be filled in place through Map()
+	explicit VertexBuffer(unsigned int size);
 	~VertexBuffer();
 
 	void Bind() const;
 	void Unbind() const;
-};
\ No newline at end of file
+
+	// Replaces the whole store; the old one is orphaned so in-flight draws are not stalled
+	void SetData(const void* data, unsigned int size);
+
+	// Maps [offset, offset + length) for writing; the previous contents of the range are
+	// discarded. Only ranges passed to FlushMappedRange reach the GPU.
+	void* Map(unsigned int offset, unsigned int length);
+	// offset is relative to the start of the mapped range
+	void FlushMappedRange(unsigned int offset, unsigned int length);
+	// Returns false if the store was lost while mapped and must be filled again
+	bool Unmap();
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+};
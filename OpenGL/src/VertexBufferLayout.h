@@ -63,6 +63,35 @@ public:
 		m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE) * count;
 	}
 
-	inline const std::vector<VertexBufferElement> GetElements() const { return m_Elements; }
+	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
 	inline unsigned int GetStride() const { return m_Stride; }
+
+	// FNV-1a over the element descriptions, used to share vertex arrays between meshes
+	size_t GetHash() const
+	{
+		size_t hash = 2166136261u;
+		auto mix = [&hash](unsigned int value) { hash = (hash ^ value) * 16777619u; };
+		for (const auto& element : m_Elements)
+		{
+			mix(element.type);
+			mix(element.count);
+			mix(element.normalized);
+		}
+		mix(m_Stride);
+		return hash;
+	}
+
+	bool operator==(const VertexBufferLayout& other) const
+	{
+		if (m_Stride != other.m_Stride || m_Elements.size() != other.m_Elements.size())
+			return false;
+		for (unsigned int i = 0; i < m_Elements.size(); i++)
+		{
+			const auto& a = m_Elements[i];
+			const auto& b = other.m_Elements[i];
+			if (a.type != b.type || a.count != b.count || a.normalized != b.normalized)
+				return false;
+		}
+		return true;
+	}
 };
\ No newline at end of file